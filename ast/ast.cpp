@@ -49,6 +49,36 @@ std::string NodeEnumToString(NodeType node_type) {
   return type_str;
 }
 
+Program Program::Extending() const {
+  std::vector<std::shared_ptr<AstArena>> arenas = appended_arenas_;
+  arenas.push_back(arena_);
+  Program program = Program(std::make_shared<AstArena>(), std::move(arenas));
+  program.compact_bytes_ = CompactBytes();
+  return program;
+}
+
+std::size_t Program::RetainedBytes() const {
+  std::size_t bytes = arena_->BytesUsed();
+  for (const std::shared_ptr<AstArena> &arena : appended_arenas_)
+    bytes += arena->BytesUsed();
+  return bytes;
+}
+
+void Program::Append(const Program &other) {
+  for (std::queue<StatementPtr> pending = other.body_; !pending.empty();
+       pending.pop()) {
+    body_.push(pending.front());
+  }
+  statement_ranges_.insert(statement_ranges_.end(),
+                           other.statement_ranges_.begin(),
+                           other.statement_ranges_.end());
+
+  if (other.arena_ != arena_) appended_arenas_.push_back(other.arena_);
+  appended_arenas_.insert(appended_arenas_.end(),
+                          other.appended_arenas_.begin(),
+                          other.appended_arenas_.end());
+}
+
 void Program::PrintOstream(std::ostream &out) const {
   out << NodeEnumToString(Type()) << " {\n";
 
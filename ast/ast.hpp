@@ -6,9 +6,16 @@
 #ifndef AST_H
 #define AST_H
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <queue>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
+#include "ast_arena.hpp"
 #include "token.hpp"
 
 class Statement;
@@ -24,14 +31,15 @@ class NumberExpression;
 class WhitespaceExpression;
 class NullExpression;
 
-typedef std::shared_ptr<Statement> StatementPtr;
-typedef std::shared_ptr<Expression> ExpressionPtr;
+// Non-owning, the nodes belong to the AstArena of their Program
+typedef Statement *StatementPtr;
+typedef Expression *ExpressionPtr;
 
 /**
  * @brief Enum class for the different types of Statement and Expression in the
  * AST.
  */
-enum class NodeType {
+enum class NodeType : std::uint8_t {
   // Statement
   Program,
   VariableDeclarationStmt,
@@ -57,11 +65,26 @@ enum class NodeType {
  */
 std::string NodeEnumToString(NodeType node_type);
 
+/**
+ * @brief Range [begin, end) of token indices
+ */
+struct TokenRange {
+  std::uint32_t begin = 0;
+  std::uint32_t end = 0;
+};
+
 /**
  * @brief Base class for all Statement and Expression classes.
  */
 class Statement {
  public:
+  /**
+   * @brief Tokens the node was parsed from, counted from the first token of
+   * its top-level statement (Program::statement_ranges_ places that one in
+   * the token stream). Empty for the nodes not built by the Parser.
+   */
+  TokenRange token_range_;
+
   /**
    * @brief Type method to get the NodeType of the Statement or Expression.
    */
@@ -82,20 +105,93 @@ class Statement {
  * Expression.
  */
 class Program : public Statement {
+ private:
+  // Owns the nodes of the program, shared by the copies of the Program
+  std::shared_ptr<AstArena> arena_;
+  // Arenas of the Programs appended to (or extended by) this one
+  std::vector<std::shared_ptr<AstArena>> appended_arenas_;
+  // Bytes used by the arenas when the nodes were last parsed in one go, 0 if
+  // they still are (see Extending())
+  std::size_t compact_bytes_ = 0;
+
+  Program(std::shared_ptr<AstArena> arena,
+          std::vector<std::shared_ptr<AstArena>> appended_arenas)
+      : arena_(std::move(arena)),
+        appended_arenas_(std::move(appended_arenas)) {}
+
  public:
   /**
    * @brief Default constructor for the Program class.
    */
-  Program() { body_ = std::queue<StatementPtr>(); }
+  Program() : arena_(std::make_shared<AstArena>()) {}
 
   /**
    * @brief Constructor for the Program class that takes a queue of Statement
    * and Expression.
+   * @pre The nodes must outlive the Program (e.g. belong to another arena)
    * @param stmt_vec The queue of Statement and Expression.
    */
-  Program(std::queue<StatementPtr> stmt_vec) : body_(stmt_vec){};
+  Program(std::queue<StatementPtr> stmt_vec)
+      : arena_(std::make_shared<AstArena>()), body_(stmt_vec){};
+
+  /**
+   * @brief Construct an empty Program allocating its nodes in an arena of its
+   * own and keeping the arenas of this one alive, so it can hold any node of
+   * this one too. This Program is left unchanged, so several Programs can
+   * extend it at the same time.
+   * @return Program the empty Program
+   */
+  Program Extending() const;
+
+  /**
+   * @brief Construct a node owned by the Program
+   * @param args the arguments of the constructor of the node
+   * @return T * the node, valid as long as a copy of the Program exists
+   */
+  template <typename T, typename... Args>
+  T *New(Args &&...args) {
+    return arena_->New<T>(std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief Copy a text (an identifier, a string) into the Program
+   * @param text the text to copy
+   * @return std::string_view the copy, valid as long as a copy of the Program
+   * exists
+   */
+  std::string_view CopyText(std::string_view text) {
+    return arena_->CopyText(text);
+  }
+
+  /**
+   * @brief Add the statements of another Program (and their token ranges)
+   * after the ones of this Program
+   * @param other the Program to append, this Program keeps its nodes alive
+   */
+  void Append(const Program &other);
+
+  /**
+   * @brief Get the arena owning the nodes of the Program
+   * @return const AstArena & the arena
+   */
+  const AstArena &Arena() const { return *arena_; }
+
+  /**
+   * @brief Get the bytes used by every arena the Program keeps alive, its own
+   * and the ones of the Programs it was appended or extended from (including
+   * the nodes of their statements it no longer holds)
+   * @return std::size_t the bytes used by the arenas
+   */
+  std::size_t RetainedBytes() const;
 
-  virtual ~Program() = default;
+  /**
+   * @brief Get the bytes the arenas used when the nodes were last parsed in
+   * one go, before the Program was extended
+   * @return std::size_t the bytes used by the arenas of the compact Program
+   */
+  std::size_t CompactBytes() const {
+    return compact_bytes_ != 0 ? compact_bytes_ : RetainedBytes();
+  }
 
   /**
    * @brief Queue of Statement and Expression. This is going to be used to
@@ -103,6 +199,14 @@ class Program : public Statement {
    */
   std::queue<StatementPtr> body_;
 
+  /**
+   * @brief Tokens of each statement of body_, in the same order: from its
+   * first token to the token the Parser looked at after it (the first token
+   * of the next statement, or TokenType::EOL). Filled by the Parser, empty for
+   * a Program built from a queue.
+   */
+  std::vector<TokenRange> statement_ranges_;
+
   /**
    * @brief Type method to get the NodeType of the Statement or Expression.
    * @return The Program NodeType.
@@ -146,11 +250,10 @@ class BinaryExpression : public Expression {
    * @param op The operator.
    * @param right The right Expression.
    */
-  BinaryExpression(ExpressionPtr left, std::string op, ExpressionPtr right)
+  BinaryExpression(ExpressionPtr left, std::string_view op,
+                   ExpressionPtr right)
       : left_(left), right_(right), op_(op){};
 
-  virtual ~BinaryExpression() = default;
-
   /**
    * @brief Left Expression.
    */
@@ -162,7 +265,7 @@ class BinaryExpression : public Expression {
   /**
    * @brief Operator. "+", "-", "*", "/", etc.
    */
-  std::string op_;
+  std::string_view op_;
 
   /**
    * @brief Type method to get the NodeType of the Statement or Expression.
@@ -200,14 +303,12 @@ class IdentifierExpression : public Expression {
    * identifier.
    * @param identifier The identifier, the variable name.
    */
-  IdentifierExpression(std::string identifier) : identifier_(identifier){};
-
-  virtual ~IdentifierExpression() = default;
+  IdentifierExpression(std::string_view identifier) : identifier_(identifier){};
 
   /**
    * @brief The name of the variable.
    */
-  std::string identifier_;
+  std::string_view identifier_;
 
   /**
    * @brief Type method to get the NodeType of the Statement or Expression.
@@ -246,8 +347,6 @@ class NumberExpression : public Expression {
    */
   NumberExpression(double tok_value) : tok_value_(tok_value){};
 
-  virtual ~NumberExpression() = default;
-
   /**
    * @brief The number in double.
    */
@@ -289,14 +388,12 @@ class WhitespaceExpression : public Expression {
    * whitespace.
    * @param tok_value The whitespace.
    */
-  WhitespaceExpression(std::string tok_value) : tok_value_(tok_value){};
-
-  virtual ~WhitespaceExpression() = default;
+  WhitespaceExpression(std::string_view tok_value) : tok_value_(tok_value){};
 
   /**
    * @brief The whitespace. (Can be multiple whitespaces)
    */
-  std::string tok_value_;
+  std::string_view tok_value_;
 
   /**
    * @brief Type method to get the NodeType of the Statement or Expression.
@@ -334,8 +431,6 @@ class NullExpression : public Expression {
    */
   NullExpression(){};
 
-  virtual ~NullExpression() = default;
-
   /**
    * @brief Type method to get the NodeType of the Statement or Expression.
    * @return The NullExpression NodeType.
@@ -371,14 +466,12 @@ class BooleanExpression : public Expression {
    * @brief Constructor for the BooleanExpression class that takes a boolean.
    * @param boolean The boolean.
    */
-  BooleanExpression(std::string boolean) : boolean_(boolean){};
+  BooleanExpression(std::string_view boolean) : boolean_(boolean){};
 
   /**
    * @brief The boolean. "true" or "false".
    */
-  std::string boolean_;
-
-  virtual ~BooleanExpression() = default;
+  std::string_view boolean_;
 
   /**
    * @brief Type method to get the NodeType of the Statement or Expression.
@@ -423,8 +516,6 @@ class NotExpression : public Expression {
    */
   ExpressionPtr expr_;
 
-  virtual ~NotExpression() = default;
-
   /**
    * @brief Type method to get the NodeType of the Statement or Expression.
    * @return The NotExpression NodeType.
@@ -458,13 +549,11 @@ class VariableDeclarationStatement : public Statement {
  public:
   /**
    * @brief Constructor for the VariableDeclarationStatement class that takes an
-   * identifier.
+   * identifier, the value is null.
    * @param identifier The identifier of the variable.
    */
-  VariableDeclarationStatement(std::string identifier) {
-    identifier_ = identifier;
-    value_ = ExpressionPtr(new NullExpression());
-  };
+  VariableDeclarationStatement(std::string_view identifier)
+      : identifier_(identifier), value_(NoValue()){};
 
   /**
    * @brief Constructor for the VariableDeclarationStatement class that takes an
@@ -475,20 +564,37 @@ class VariableDeclarationStatement : public Statement {
    * @param value The value of the variable that will be assigned to the
    * identifier.
    */
-  VariableDeclarationStatement(std::string identifier, ExpressionPtr value)
+  VariableDeclarationStatement(std::string_view identifier, ExpressionPtr value)
       : identifier_(identifier), value_(value){};
 
-  virtual ~VariableDeclarationStatement() = default;
-
   /**
    * @brief The identifier of the variable.
    */
-  std::string identifier_;
+  std::string_view identifier_;
   /**
    * @brief The value of the variable that will be assigned to the identifier.
    */
   ExpressionPtr value_;
 
+ private:
+  /**
+   * @brief Get the value of the declarations without one, a NullExpression
+   * shared by all of them (so it belongs to no arena)
+   * @return ExpressionPtr the NullExpression
+   */
+  static ExpressionPtr NoValue() {
+    static NullExpression no_value;
+    return &no_value;
+  }
+
+ public:
+  /**
+   * @brief Check if the declaration has a value ("set a = 1" rather than
+   * "set a")
+   * @return bool true if the value was given
+   */
+  bool HasValue() const { return value_ != NoValue(); }
+
   /**
    * @brief Type method to get the NodeType of the Statement or Expression.
    * @return The VariableDeclarationStatement NodeType.
@@ -529,15 +635,13 @@ class VariableAssignExpression : public Expression {
    * @param value The value of the variable that will be assigned to the
    * identifier.
    */
-  VariableAssignExpression(std::string identifier, StatementPtr value)
+  VariableAssignExpression(std::string_view identifier, StatementPtr value)
       : Name(identifier), Value(value){};
 
-  virtual ~VariableAssignExpression() = default;
-
   /**
    * @brief The identifier of the variable.
    */
-  std::string Name;
+  std::string_view Name;
   /**
    * @brief The value of the variable that will be assigned to the identifier.
    */
@@ -581,7 +685,8 @@ class ComparisonExpression : public Expression {
    * @param op The operator.
    * @param rhs The right Expression.
    */
-  ComparisonExpression(ExpressionPtr lhs, std::string op, ExpressionPtr rhs)
+  ComparisonExpression(ExpressionPtr lhs, std::string_view op,
+                       ExpressionPtr rhs)
       : left_(lhs), op_(op), right_(rhs){};
 
   /**
@@ -591,14 +696,12 @@ class ComparisonExpression : public Expression {
   /**
    * @brief The operator. "==" or "!="
    */
-  std::string op_;
+  std::string_view op_;
   /**
    * @brief The right Expression.
    */
   ExpressionPtr right_;
 
-  virtual ~ComparisonExpression() = default;
-
   /**
    * @brief Type method to get the NodeType of the Statement or Expression.
    * @return The ComparisonExpression NodeType.
@@ -628,14 +731,12 @@ class StringExpression : public Expression {
    * @brief Constructor for the StringExpression class that takes a string.
    * @param str The string value.
    */
-  StringExpression(std::string str) : tok_value_(str){};
+  StringExpression(std::string_view str) : tok_value_(str){};
 
   /**
    * @brief The string value.
    */
-  std::string tok_value_;
-
-  virtual ~StringExpression() = default;
+  std::string_view tok_value_;
 
   /**
    * @brief Type method to get the NodeType of the Statement or Expression.
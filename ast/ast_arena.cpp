@@ -0,0 +1,44 @@
+#include "ast_arena.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+AstArena::AstArena()
+    : blocks_(nullptr),
+      cursor_(inline_block_),
+      end_(inline_block_ + kInlineBlockSize),
+      next_block_size_(kMinBlockSize),
+      bytes_used_(0) {}
+
+AstArena::~AstArena() {
+  while (blocks_ != nullptr) {
+    Block *previous = blocks_->previous;
+    ::operator delete(blocks_);
+    blocks_ = previous;
+  }
+}
+
+void AstArena::Grow(std::size_t size, std::size_t alignment) {
+  // The bytes of a block start right after its header, aligned for any type
+  constexpr std::size_t kHeaderSize =
+      (sizeof(Block) + alignof(std::max_align_t) - 1) &
+      ~(alignof(std::max_align_t) - 1);
+
+  // Nodes larger than a block get a block of their own
+  std::size_t block_size = std::max(next_block_size_, size + alignment);
+  next_block_size_ = std::min(next_block_size_ * 2, kMaxBlockSize);
+
+  std::byte *memory =
+      static_cast<std::byte *>(::operator new(kHeaderSize + block_size));
+  blocks_ = new (memory) Block{blocks_};
+  cursor_ = memory + kHeaderSize;
+  end_ = cursor_ + block_size;
+}
+
+std::string_view AstArena::CopyText(std::string_view text) {
+  if (text.empty()) return std::string_view();
+
+  char *copy = static_cast<char *>(Allocate(text.size(), alignof(char)));
+  std::memcpy(copy, text.data(), text.size());
+  return std::string_view(copy, text.size());
+}
@@ -0,0 +1,119 @@
+/**
+ * @file ast_arena.hpp
+ * @brief Contains the AstArena class, the bump allocator owning the nodes (and
+ * their text) of a Program
+ */
+#ifndef AST_ARENA_H
+#define AST_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Bump allocator for AST nodes. Nodes are placed one after the other in
+ * blocks of growing size (the first one inside the arena itself), and are
+ * never destroyed one by one: the arena frees its blocks at once, so the nodes
+ * must be trivially destructible and may only point to memory of the same
+ * arena (or memory outliving it).
+ */
+class AstArena {
+ public:
+  /**
+   * @brief Bytes of the block stored inside the arena, enough for the AST of
+   * a short expression
+   */
+  static constexpr std::size_t kInlineBlockSize = 512;
+  /**
+   * @brief Bytes of the first heap block, each next one doubles up to
+   * kMaxBlockSize
+   */
+  static constexpr std::size_t kMinBlockSize = 4096;
+  static constexpr std::size_t kMaxBlockSize = 64 * 1024;
+
+ private:
+  // Header of a heap block, its bytes follow it
+  struct Block {
+    Block *previous;
+  };
+
+  alignas(std::max_align_t) std::byte inline_block_[kInlineBlockSize];
+  // Last heap block, nullptr while the inline block is enough
+  Block *blocks_;
+  std::byte *cursor_;
+  std::byte *end_;
+  std::size_t next_block_size_;
+  std::size_t bytes_used_;
+
+  /**
+   * @brief Start a heap block holding at least size bytes aligned to
+   * alignment
+   * @param size the number of bytes of the allocation which did not fit
+   * @param alignment the alignment of the allocation
+   */
+  void Grow(std::size_t size, std::size_t alignment);
+
+ public:
+  /**
+   * @brief Construct an empty arena (no heap block is allocated)
+   */
+  AstArena();
+  ~AstArena();
+
+  // Nodes point into the arena's own blocks
+  AstArena(const AstArena &) = delete;
+  AstArena &operator=(const AstArena &) = delete;
+
+  /**
+   * @brief Allocate uninitialized memory
+   * @param size the number of bytes
+   * @param alignment the alignment of the memory, a power of 2 up to
+   * alignof(std::max_align_t)
+   * @return void * the memory, valid until the arena is destroyed
+   */
+  void *Allocate(std::size_t size, std::size_t alignment) {
+    std::size_t padding =
+        (alignment - reinterpret_cast<std::uintptr_t>(cursor_)) &
+        (alignment - 1);
+    if (static_cast<std::size_t>(end_ - cursor_) < padding + size) {
+      Grow(size, alignment);
+      padding = 0;
+    }
+
+    std::byte *memory = cursor_ + padding;
+    cursor_ = memory + size;
+    bytes_used_ += size;
+    return memory;
+  }
+
+  /**
+   * @brief Construct a node in the arena
+   * @param args the arguments of the constructor of T
+   * @return T * the node, owned by the arena
+   */
+  template <typename T, typename... Args>
+  T *New(Args &&...args) {
+    static_assert(std::is_trivially_destructible_v<T>,
+                  "The arena never runs the destructors of its nodes");
+    return new (Allocate(sizeof(T), alignof(T)))
+        T(std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief Copy a text into the arena
+   * @param text the text to copy
+   * @return std::string_view the copy, owned by the arena
+   */
+  std::string_view CopyText(std::string_view text);
+
+  /**
+   * @brief Get the number of bytes handed out (padding excluded)
+   * @return std::size_t the number of bytes allocated in the arena
+   */
+  std::size_t BytesUsed() const { return bytes_used_; }
+};
+
+#endif
@@ -0,0 +1,159 @@
+#include "flat_ast.hpp"
+
+FlatAst::FlatAst(const Program &program) {
+  std::queue<StatementPtr> pending = program.body_;
+  statements_.reserve(pending.size());
+
+  while (!pending.empty()) {
+    statements_.push_back(Append(*pending.front()));
+    pending.pop();
+  }
+}
+
+std::uint32_t FlatAst::AppendNode(NodeType kind, FlatNode node) {
+  kinds_.push_back(kind);
+  nodes_.push_back(node);
+  return static_cast<std::uint32_t>(nodes_.size() - 1);
+}
+
+std::uint32_t FlatAst::AddText(std::string_view text) {
+  texts_.emplace_back(static_cast<std::uint32_t>(text_pool_.size()),
+                      static_cast<std::uint32_t>(text.size()));
+  text_pool_.append(text);
+  return static_cast<std::uint32_t>(texts_.size() - 1);
+}
+
+std::uint32_t FlatAst::Append(const Statement &stmt) {
+  // Children first, so the nodes end up in post-order
+  switch (stmt.Type()) {
+    case NodeType::NumberExpr: {
+      const auto &num_expr = static_cast<const NumberExpression &>(stmt);
+      numbers_.push_back(num_expr.tok_value_);
+      return AppendNode(
+          stmt.Type(),
+          {kNoNode, kNoNode, static_cast<std::uint32_t>(numbers_.size() - 1)});
+    }
+    case NodeType::IdentifierExpr: {
+      const auto &identifier_expr =
+          static_cast<const IdentifierExpression &>(stmt);
+      return AppendNode(stmt.Type(), {kNoNode, kNoNode,
+                                      AddText(identifier_expr.identifier_)});
+    }
+    case NodeType::StringExpr: {
+      const auto &str_expr = static_cast<const StringExpression &>(stmt);
+      return AppendNode(stmt.Type(),
+                        {kNoNode, kNoNode, AddText(str_expr.tok_value_)});
+    }
+    case NodeType::WhitespaceExpr: {
+      const auto &whitespace_expr =
+          static_cast<const WhitespaceExpression &>(stmt);
+      return AppendNode(stmt.Type(), {kNoNode, kNoNode,
+                                      AddText(whitespace_expr.tok_value_)});
+    }
+    case NodeType::BooleanExpr: {
+      const auto &bool_expr = static_cast<const BooleanExpression &>(stmt);
+      return AppendNode(stmt.Type(),
+                        {kNoNode, kNoNode, AddText(bool_expr.boolean_)});
+    }
+    case NodeType::NotExpr: {
+      const auto &not_expr = static_cast<const NotExpression &>(stmt);
+      std::uint32_t operand = Append(*not_expr.expr_);
+      return AppendNode(stmt.Type(), {operand, kNoNode, kNoNode});
+    }
+    case NodeType::BinaryExpr: {
+      const auto &binary_expr = static_cast<const BinaryExpression &>(stmt);
+      std::uint32_t left = Append(*binary_expr.left_);
+      std::uint32_t right = Append(*binary_expr.right_);
+      return AppendNode(stmt.Type(), {left, right, AddText(binary_expr.op_)});
+    }
+    case NodeType::ComparisonExpr: {
+      const auto &compare_expr =
+          static_cast<const ComparisonExpression &>(stmt);
+      std::uint32_t left = Append(*compare_expr.left_);
+      std::uint32_t right = Append(*compare_expr.right_);
+      return AppendNode(stmt.Type(), {left, right, AddText(compare_expr.op_)});
+    }
+    case NodeType::VariableDeclarationStmt: {
+      const auto &var_decl_stmt =
+          static_cast<const VariableDeclarationStatement &>(stmt);
+      std::uint32_t value = Append(*var_decl_stmt.value_);
+      return AppendNode(stmt.Type(), {value, kNoNode,
+                                      AddText(var_decl_stmt.identifier_)});
+    }
+    case NodeType::VariableAssignExpr: {
+      const auto &var_assign_expr =
+          static_cast<const VariableAssignExpression &>(stmt);
+      std::uint32_t value = Append(*var_assign_expr.Value);
+      return AppendNode(stmt.Type(),
+                        {value, kNoNode, AddText(var_assign_expr.Name)});
+    }
+    default:
+      // Null, and the kinds which are never part of a body (Program)
+      return AppendNode(stmt.Type(), {kNoNode, kNoNode, kNoNode});
+  }
+}
+
+std::size_t FlatAst::MemoryUsage() const {
+  return kinds_.capacity() * sizeof(NodeType) +
+         nodes_.capacity() * sizeof(FlatNode) +
+         statements_.capacity() * sizeof(std::uint32_t) +
+         numbers_.capacity() * sizeof(double) + text_pool_.capacity() +
+         texts_.capacity() * sizeof(texts_[0]);
+}
+
+void FlatAst::PrintNode(std::ostream &out, std::uint32_t index) const {
+  const FlatNode &node = nodes_[index];
+  NodeType kind = kinds_[index];
+  out << NodeEnumToString(kind);
+
+  switch (kind) {
+    case NodeType::VariableDeclarationStmt:
+    case NodeType::VariableAssignExpr:
+      out << " (Identifier : " << Text(index) << ", Value : ";
+      PrintNode(out, node.first);
+      out << " )";
+      break;
+    case NodeType::BinaryExpr:
+    case NodeType::ComparisonExpr:
+      out << " (Left Value : ";
+      PrintNode(out, node.first);
+      out << ", Op Value : " << Text(index) << ", Right Value : ";
+      PrintNode(out, node.second);
+      out << ", )";
+      break;
+    case NodeType::IdentifierExpr:
+      out << " (Name : " << Text(index) << ")";
+      break;
+    case NodeType::NumberExpr:
+      out << " (Value : " << Number(index) << ")";
+      break;
+    case NodeType::WhitespaceExpr:
+      out << " (Value : '" << Text(index) << "' )";
+      break;
+    case NodeType::NotExpr:
+      out << " (Value : '";
+      PrintNode(out, node.first);
+      out << "' )";
+      break;
+    case NodeType::NullExpr:
+      out << " ( Value : 'NULL' )";
+      break;
+    case NodeType::BooleanExpr:
+    case NodeType::StringExpr:
+      out << " ( Value : '" << Text(index) << "' )";
+      break;
+    default:
+      break;
+  }
+}
+
+std::ostream &operator<<(std::ostream &out, const FlatAst &flat_ast) {
+  out << NodeEnumToString(NodeType::Program) << " {\n";
+  for (std::uint32_t statement : flat_ast.statements_) {
+    flat_ast.PrintNode(out, statement);
+    out << "\n";
+  }
+  out << "}";
+
+  return out;
+}
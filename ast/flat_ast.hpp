@@ -0,0 +1,161 @@
+/**
+ * @file flat_ast.hpp
+ * @brief Contains the FlatAst class, a compact representation of a Program
+ * made of contiguous arrays instead of a tree of nodes
+ */
+#ifndef FLAT_AST_H
+#define FLAT_AST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "ast.hpp"
+
+/**
+ * @brief Children and value of a node of a FlatAst (12 bytes, no pointer)
+ */
+struct FlatNode {
+  // Child indices, kNoNode if the kind has fewer children:
+  // Binary/Comparison (left, right), Not (operand), VariableDeclaration and
+  // VariableAssign (value)
+  std::uint32_t first;
+  std::uint32_t second;
+  // Index in the side table of the kind: FlatAst::Number() for NumberExpr,
+  // FlatAst::Text() for the other kinds with a text (the identifier, string,
+  // boolean, whitespace, operator or declared/assigned name)
+  std::uint32_t value;
+};
+
+/**
+ * @brief A Program stored as flat arrays. Node i has its kind in a byte array
+ * and its FlatNode in another; numbers and texts are in side tables. Nodes are
+ * in post-order (the children of a node come before it, the statements one
+ * after the other), so evaluating the program is a single forward walk over
+ * the arrays.
+ */
+class FlatAst {
+ public:
+  static constexpr std::uint32_t kNoNode =
+      std::numeric_limits<std::uint32_t>::max();
+
+ private:
+  std::vector<NodeType> kinds_;
+  std::vector<FlatNode> nodes_;
+  // Indices of the root node of every statement, increasing
+  std::vector<std::uint32_t> statements_;
+
+  std::vector<double> numbers_;
+  // Texts are stored back to back in text_pool_, texts_[k] is the
+  // (offset, length) of text k
+  std::string text_pool_;
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> texts_;
+
+  /**
+   * @brief Append the nodes of a statement (and its children) in post-order
+   * @param stmt the statement to append
+   * @return std::uint32_t the index of the statement's node
+   */
+  std::uint32_t Append(const Statement &stmt);
+
+  /**
+   * @brief Append a node
+   * @param kind the kind of the node
+   * @param node the children and value of the node
+   * @return std::uint32_t the index of the node
+   */
+  std::uint32_t AppendNode(NodeType kind, FlatNode node);
+
+  /**
+   * @brief Add a text to the side table
+   * @param text the text
+   * @return std::uint32_t the index of the text
+   */
+  std::uint32_t AddText(std::string_view text);
+
+  /**
+   * @brief Print a node and its children, as the node of a Program prints
+   * @param out the output stream
+   * @param index the index of the node
+   */
+  void PrintNode(std::ostream &out, std::uint32_t index) const;
+
+ public:
+  /**
+   * @brief Construct an empty FlatAst (no statement)
+   */
+  FlatAst() = default;
+
+  /**
+   * @brief Flatten a Program, the FlatAst does not refer to it
+   * @param program the Program to flatten
+   */
+  explicit FlatAst(const Program &program);
+
+  /**
+   * @brief Get the number of nodes
+   * @return std::size_t the number of nodes
+   */
+  std::size_t Size() const { return kinds_.size(); }
+
+  /**
+   * @brief Get the kind of a node
+   * @param index the index of the node
+   * @return NodeType the kind of the node
+   */
+  NodeType Kind(std::size_t index) const { return kinds_[index]; }
+
+  /**
+   * @brief Get the children and value of a node
+   * @param index the index of the node
+   * @return const FlatNode & the children and value of the node
+   */
+  const FlatNode &Node(std::size_t index) const { return nodes_[index]; }
+
+  /**
+   * @brief Get the root nodes of the statements, in program order
+   * @return const std::vector<std::uint32_t> & the indices of the statements
+   */
+  const std::vector<std::uint32_t> &Statements() const { return statements_; }
+
+  /**
+   * @brief Get the number of a NumberExpr node
+   * @param index the index of the node
+   * @return double the value of the number
+   */
+  double Number(std::size_t index) const {
+    return numbers_[nodes_[index].value];
+  }
+
+  /**
+   * @brief Get the text of a node (see FlatNode::value)
+   * @param index the index of the node
+   * @return std::string_view the text of the node
+   */
+  std::string_view Text(std::size_t index) const {
+    const auto &[offset, length] = texts_[nodes_[index].value];
+    return std::string_view(text_pool_).substr(offset, length);
+  }
+
+  /**
+   * @brief Get the number of bytes held by the arrays and side tables
+   * @return std::size_t the memory used by the FlatAst
+   */
+  std::size_t MemoryUsage() const;
+
+  /**
+   * @brief Print the FlatAst, in the same format as the Program it was
+   * flattened from
+   * @param out the output stream
+   * @param flat_ast the FlatAst to print
+   * @return std::ostream & the output stream
+   */
+  friend std::ostream &operator<<(std::ostream &out, const FlatAst &flat_ast);
+};
+
+#endif
@@ -1,29 +1,78 @@
 #include "file.hpp"
 
-#include <sstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
 
 #include "stringutil.hpp"
 
 File::File(std::string filename) {
   filename_ = filename;
-  std::ifstream fs;
+  mapped_data_ = nullptr;
+  mapped_size_ = 0;
 
-  fs.open(filename_);
-  if (!fs.is_open()) {
+  int fd = open(filename_.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
     throw FileNotOpenedException();
   }
 
-  std::stringstream ss;
-  ss << fs.rdbuf();
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) == 0 && S_ISREG(file_stat.st_mode) &&
+      file_stat.st_size > 0) {
+    void *mapped = mmap(nullptr, static_cast<std::size_t>(file_stat.st_size),
+                        PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped != MAP_FAILED) {
+      mapped_data_ = mapped;
+      mapped_size_ = static_cast<std::size_t>(file_stat.st_size);
+      // The lexer reads the script front to back
+      madvise(mapped_data_, mapped_size_, MADV_SEQUENTIAL);
+    }
+  }
+
+  // Pipes, character devices and failed mappings are read instead
+  if (mapped_data_ == nullptr) {
+    try {
+      ReadAll(fd);
+    } catch (...) {
+      close(fd);
+      throw;
+    }
+  }
 
-  fs.close();
+  close(fd);
+
+  if (mapped_data_ != nullptr) {
+    data_ = std::string_view(static_cast<const char *>(mapped_data_),
+                             mapped_size_);
+  } else {
+    data_ = file_data_;
+  }
+}
 
-    filename_ = ss.str();
+File::~File() {
+  if (mapped_data_ != nullptr) munmap(mapped_data_, mapped_size_);
 }
 
-File::~File() {}
+void File::ReadAll(int fd) {
+  char buffer[64 * 1024];
+
+  while (true) {
+    ssize_t read_size = read(fd, buffer, sizeof(buffer));
+    if (read_size < 0 && errno == EINTR) continue;
+    if (read_size < 0) throw FileNotOpenedException();
+    if (read_size == 0) break;
+    file_data_.append(buffer, static_cast<std::size_t>(read_size));
+  }
+}
 
 std::string File::Read() const {
-  if (file_data_.empty()) throw FileNotOpenedException();
-  return file_data_;
-}
\ No newline at end of file
+  if (data_.empty()) throw FileNotOpenedException();
+  return std::string(data_);
+}
+
+std::string_view File::View() const { return data_; }
+
+bool File::IsMapped() const { return mapped_data_ != nullptr; }
@@ -5,17 +5,29 @@
 #ifndef FILE_H
 #define FILE_H
 
-#include <fstream>
+#include <cstddef>
 #include <memory>
 #include <string>
+#include <string_view>
 
 /**
- * @brief File class to read the script file
+ * @brief File class to read the script file. Regular files are memory mapped
+ * read-only, anything else (pipes, character devices) is read into memory.
  */
 class File {
  private:
   std::string filename_;
+  // Used when the file can't be memory mapped
   std::string file_data_;
+  void *mapped_data_;
+  std::size_t mapped_size_;
+  std::string_view data_;
+
+  /**
+   * @brief Read the whole file descriptor into file_data_ (read() fallback)
+   * @param fd the file descriptor to read
+   */
+  void ReadAll(int fd);
 
  public:
   /**
@@ -25,11 +37,27 @@ class File {
   File(std::string filename);
   ~File();
 
+  // The File owns the mapping, copying it would unmap the data twice
+  File(const File &) = delete;
+  File &operator=(const File &) = delete;
+
   /**
    * @brief Read the file and return the entire script line
    * @return std::string File data
    */
   std::string Read() const;
+
+  /**
+   * @brief Get the file contents without copying them
+   * @return std::string_view File data, valid as long as the File object
+   */
+  std::string_view View() const;
+
+  /**
+   * @brief Check if the file contents are memory mapped
+   * @return bool True if memory mapped, false if read into memory
+   */
+  bool IsMapped() const;
 };
 
 /**
@@ -42,4 +70,4 @@ class FileNotOpenedException : public std::exception {
 
 typedef std::shared_ptr<File> FilePtr;
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,188 @@
+/**
+ * @file char_class.hpp
+ * @brief Compile time generated tables driving the Lexer: a 256 entry table
+ * mapping every byte to its CharClass and a transition table mapping the
+ * class of a token's first byte to the scanner which lexes the token. Both
+ * are built from the declarative rules below, so a new token class is a new
+ * rule rather than a new branch in Lexer::Scan.
+ */
+#ifndef CHAR_CLASS_H
+#define CHAR_CLASS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "operator.hpp"
+
+/**
+ * @brief Class of a byte, as seen at the beginning of a token
+ */
+enum class CharClass : std::uint8_t {
+  INVALID,
+  END,
+  WHITESPACE,
+  OPERATOR,
+  QUOTE,
+  DIGIT,
+  LETTER,
+  // First byte of a multi byte UTF-8 sequence
+  UTF8_LEAD,
+};
+
+/**
+ * @brief Scanner the Lexer runs for a token, chosen by the class of its first
+ * byte
+ */
+enum class LexAction : std::uint8_t {
+  ERROR,
+  EOL,
+  WHITESPACE,
+  OPERATOR,
+  STRING,
+  NUMBER,
+  IDENTIFIER,
+};
+
+namespace lexer_dfa {
+
+inline constexpr std::size_t kCharClassCount =
+    static_cast<std::size_t>(CharClass::UTF8_LEAD) + 1;
+
+/**
+ * @brief The bytes first..last (inclusive) belong to char_class
+ */
+struct ByteRange {
+  unsigned char first;
+  unsigned char last;
+  CharClass char_class;
+};
+
+/**
+ * @brief A token whose first byte is of class char_class is lexed by action
+ */
+struct StartRule {
+  CharClass char_class;
+  LexAction action;
+};
+
+/**
+ * @brief Classes of the bytes which are not operators. The operator bytes
+ * come from kOperatorTable, every other byte is CharClass::INVALID.
+ */
+inline constexpr std::array<ByteRange, 8> kByteRanges = {{
+    {'\0', '\0', CharClass::END},  // Also returned past the end of the input
+    {'\t', '\r', CharClass::WHITESPACE},  // \t, \n, \v, \f, \r
+    {' ', ' ', CharClass::WHITESPACE},
+    {'"', '"', CharClass::QUOTE},
+    {'0', '9', CharClass::DIGIT},
+    {'A', 'Z', CharClass::LETTER},
+    {'a', 'z', CharClass::LETTER},
+    {0xC2, 0xF4, CharClass::UTF8_LEAD},
+}};
+
+// Non ASCII identifiers are checked for XID_Start by the scanner
+inline constexpr std::array<StartRule, 7> kStartRules = {{
+    {CharClass::END, LexAction::EOL},
+    {CharClass::WHITESPACE, LexAction::WHITESPACE},
+    {CharClass::OPERATOR, LexAction::OPERATOR},
+    {CharClass::QUOTE, LexAction::STRING},
+    {CharClass::DIGIT, LexAction::NUMBER},
+    {CharClass::LETTER, LexAction::IDENTIFIER},
+    {CharClass::UTF8_LEAD, LexAction::IDENTIFIER},
+}};
+
+/**
+ * @brief Build the byte to CharClass table from byte ranges and the first
+ * bytes of the operators
+ * @param ranges the classes of the non operator bytes
+ * @param operators the operator table
+ * @return std::array<CharClass, 256> the class of every byte
+ */
+template <std::size_t kRangeCount, std::size_t kOperatorCount>
+constexpr std::array<CharClass, 256> BuildCharClasses(
+    const std::array<ByteRange, kRangeCount> &ranges,
+    const std::array<OperatorInfo, kOperatorCount> &operators) {
+  std::array<CharClass, 256> classes{};
+  for (const ByteRange &range : ranges) {
+    for (unsigned ch = range.first; ch <= range.last; ch++)
+      classes[ch] = range.char_class;
+  }
+  for (const OperatorInfo &info : operators)
+    classes[static_cast<unsigned char>(info.text.front())] =
+        CharClass::OPERATOR;
+  return classes;
+}
+
+/**
+ * @brief Check that no byte is claimed by two rules (a byte range and an
+ * operator, or two byte ranges)
+ * @param ranges the classes of the non operator bytes
+ * @param operators the operator table
+ * @return bool true if every byte has at most one class
+ */
+template <std::size_t kRangeCount, std::size_t kOperatorCount>
+constexpr bool RulesAreDisjoint(
+    const std::array<ByteRange, kRangeCount> &ranges,
+    const std::array<OperatorInfo, kOperatorCount> &operators) {
+  // Operators sharing their first byte ("!" and "!=") claim it once
+  std::array<bool, 256> operator_bytes{};
+  for (const OperatorInfo &info : operators)
+    operator_bytes[static_cast<unsigned char>(info.text.front())] = true;
+
+  std::array<std::uint8_t, 256> claims{};
+  for (unsigned ch = 0; ch < 256; ch++) claims[ch] = operator_bytes[ch];
+  for (const ByteRange &range : ranges) {
+    for (unsigned ch = range.first; ch <= range.last; ch++) {
+      if (++claims[ch] > 1) return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Build the transition table of the start state: the LexAction of a
+ * token for the CharClass of its first byte
+ * @param rules the start rules
+ * @return std::array<LexAction, kCharClassCount> the action of every class
+ * (LexAction::ERROR if no rule starts with the class)
+ */
+template <std::size_t kRuleCount>
+constexpr std::array<LexAction, kCharClassCount> BuildStartTransitions(
+    const std::array<StartRule, kRuleCount> &rules) {
+  std::array<LexAction, kCharClassCount> transitions{};
+  for (const StartRule &rule : rules)
+    transitions[static_cast<std::size_t>(rule.char_class)] = rule.action;
+  return transitions;
+}
+
+inline constexpr std::array<CharClass, 256> kCharClasses =
+    BuildCharClasses(kByteRanges, kOperatorTable);
+static_assert(RulesAreDisjoint(kByteRanges, kOperatorTable),
+              "A byte belongs to two classes in kByteRanges/kOperatorTable");
+
+inline constexpr std::array<LexAction, kCharClassCount> kStartTransitions =
+    BuildStartTransitions(kStartRules);
+
+}  // namespace lexer_dfa
+
+/**
+ * @brief Get the class of a byte
+ * @param ch the byte
+ * @return CharClass the class of the byte
+ */
+constexpr CharClass ClassifyByte(char ch) {
+  return lexer_dfa::kCharClasses[static_cast<unsigned char>(ch)];
+}
+
+/**
+ * @brief Get the scanner of a token from its first byte
+ * @param ch the first byte of the token ('\0' at the end of the input)
+ * @return LexAction the scanner lexing the token
+ */
+constexpr LexAction StartAction(char ch) {
+  return lexer_dfa::kStartTransitions[static_cast<std::size_t>(
+      ClassifyByte(ch))];
+}
+
+#endif
@@ -0,0 +1,102 @@
+/**
+ * @file keyword.hpp
+ * @brief Compile time generated perfect hash over the reserved keywords
+ * (kReservedKeywords), used by the Lexer to classify identifiers without
+ * allocating or comparing against every keyword.
+ */
+#ifndef KEYWORD_H
+#define KEYWORD_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "token.hpp"
+
+namespace keyword_hash {
+
+/**
+ * @brief Number of hash slots, the smallest power of two which holds every
+ * keyword twice over
+ */
+inline constexpr std::size_t kTableSize = [] {
+  std::size_t size = 1;
+  while (size < kReservedKeywords.size() * 2) size <<= 1;
+  return size;
+}();
+
+/**
+ * @brief Hash an identifier from its length, first and last byte
+ * @param word the identifier (non empty)
+ * @param seed the multiplier picked by FindSeed
+ * @return std::size_t the slot of the identifier in the table
+ */
+constexpr std::size_t Hash(std::string_view word, std::uint32_t seed) {
+  std::uint32_t key = (static_cast<std::uint8_t>(word.front()) << 16) |
+                      (static_cast<std::uint8_t>(word.back()) << 8) |
+                      static_cast<std::uint32_t>(word.size());
+  return ((key * seed) >> 24) & (kTableSize - 1);
+}
+
+/**
+ * @brief Search for a seed which maps every keyword to its own slot
+ * @return std::uint32_t the seed, 0 if no seed was found
+ */
+constexpr std::uint32_t FindSeed() {
+  for (std::uint32_t seed = 1; seed < (1u << 16); seed += 2) {
+    std::array<bool, kTableSize> used{};
+    bool collided = false;
+    for (const ReservedKeyword &keyword : kReservedKeywords) {
+      std::size_t slot = Hash(keyword.text, seed);
+      if (used[slot]) {
+        collided = true;
+        break;
+      }
+      used[slot] = true;
+    }
+    if (!collided) return seed;
+  }
+  return 0;
+}
+
+inline constexpr std::uint32_t kSeed = FindSeed();
+static_assert(kSeed != 0,
+              "No perfect hash seed found for kReservedKeywords, increase "
+              "kTableSize or add more bytes to Hash");
+
+/**
+ * @brief Slot table, each slot holds the index of its keyword in
+ * kReservedKeywords plus one (0 for an empty slot)
+ */
+inline constexpr std::array<std::uint8_t, kTableSize> kSlots = [] {
+  std::array<std::uint8_t, kTableSize> slots{};
+  for (std::size_t i = 0; i < kReservedKeywords.size(); i++) {
+    slots[Hash(kReservedKeywords[i].text, kSeed)] =
+        static_cast<std::uint8_t>(i + 1);
+  }
+  return slots;
+}();
+
+}  // namespace keyword_hash
+
+/**
+ * @brief Classify an identifier as a reserved keyword
+ * @param word the identifier
+ * @return TokenType the keyword's TokenType, else TokenType::INVALID
+ */
+constexpr TokenType LookupReservedKeyword(std::string_view word) {
+  if (word.empty()) return TokenType::INVALID;
+
+  std::uint8_t slot =
+      keyword_hash::kSlots[keyword_hash::Hash(word, keyword_hash::kSeed)];
+  if (slot == 0) return TokenType::INVALID;
+
+  // Only one keyword can live in the slot, so a single compare confirms it
+  const ReservedKeyword &keyword = kReservedKeywords[slot - 1];
+  if (keyword.text != word) return TokenType::INVALID;
+
+  return keyword.tok_type;
+}
+
+#endif
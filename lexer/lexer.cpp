@@ -1,207 +1,690 @@
 #include "lexer.hpp"
 
-#include <cctype>
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <functional>
 #include <sstream>
 #include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
 
+#include "char_class.hpp"
 #include "file.hpp"
 #include "iostream"
-#include "stringutil.hpp"
+#include "keyword.hpp"
+#include "line_table.hpp"
+#include "number_literal.hpp"
+#include "scan.hpp"
 #include "token.hpp"
+#include "unicode.hpp"
 
 Lexer::Lexer(FilePtr file_ptr) {
   file_ptr_ = file_ptr;
-  line_ = 1;
-  text_queue_ = ConvertStringToQueue(file_ptr_->Read());
+  // The file contents (usually memory mapped) are lexed in place
+  input_ = file_ptr_->View();
+  pos_ = 0;
+  keep_whitespace_ = true;
+  decode_strings_ = true;
+  operators_ = &OperatorRegistry::Builtin();
+  base_location_ = SourceLocation{1, 1};
 }
 
 Lexer::Lexer(std::string input) {
-  text_queue_ = ConvertStringToQueue(input);
-  line_ = 1;
+  owned_input_ = std::make_shared<const std::string>(std::move(input));
+  input_ = *owned_input_;
+  pos_ = 0;
+  keep_whitespace_ = true;
+  decode_strings_ = true;
+  operators_ = &OperatorRegistry::Builtin();
+  base_location_ = SourceLocation{1, 1};
+}
+
+Lexer::Lexer(const char *data, std::size_t length) {
+  input_ = std::string_view(data, length);
+  pos_ = 0;
+  keep_whitespace_ = true;
+  decode_strings_ = true;
+  operators_ = &OperatorRegistry::Builtin();
+  base_location_ = SourceLocation{1, 1};
 }
 
 Lexer::~Lexer() {}
 
-std::string Lexer::ReadStr() {
-  if (text_queue_.front() != '\"')
-    throw WrongLexingException("Double quote for string not found");
+char Lexer::Current() const {
+  if (pos_ >= input_.size()) return '\0';
+  return input_[pos_];
+}
 
-  // Pop the double quote (starting point of the string)
-  text_queue_.pop();
+SourceLocation Lexer::Locate(std::size_t offset) const {
+  SourceLocation location = LineTable(input_).Locate(offset);
+  // Only the first line of the input continues a line of the whole source
+  if (location.line == 1) location.column += base_location_.column - 1;
+  location.line += base_location_.line - 1;
+  return location;
+}
+
+void Lexer::ThrowUnterminatedString(std::size_t start) {
+  pos_ = input_.size();
+  std::stringstream ssInvalidStrMsg;
+  ssInvalidStrMsg << "Ending double quote not found after \""
+                  << input_.substr(start + 1) << "\" (string starting at "
+                  << Locate(start) << ")";
+  throw WrongLexingException(ssInvalidStrMsg.str());
+}
 
-  std::string str_val;
+void Lexer::ThrowInvalidUtf8(std::size_t offset) {
+  unsigned char lead = static_cast<unsigned char>(input_[offset]);
+  std::size_t length = Utf8SequenceLength(lead);
+
+  // A sequence cut by the end of the input may be completed by more input
+  // (see StreamLexer), report it like an unterminated string
+  bool cut = length > 1 && offset + length > input_.size();
+  for (std::size_t i = offset + 1; cut && i < input_.size(); i++)
+    cut = (static_cast<unsigned char>(input_[i]) & 0xC0) == 0x80;
+  pos_ = cut ? input_.size() : offset;
+
+  std::stringstream ssInvalidUtf8Msg;
+  ssInvalidUtf8Msg << "Invalid UTF-8 sequence starting with byte 0x"
+                   << std::hex << std::uppercase << static_cast<int>(lead)
+                   << std::dec << " at " << Locate(offset);
+  throw WrongLexingException(ssInvalidUtf8Msg.str());
+}
 
-  while (!text_queue_.empty()) {
-    if (text_queue_.front() == '\0') {
-      std::stringstream ssInvalidStrMsg;
-      ssInvalidStrMsg << "Ending double quote not found after \"" << str_val
-                      << "\"";
-      throw WrongLexingException(ssInvalidStrMsg.str());
+std::uint32_t Lexer::ReadHex4(std::size_t string_start) {
+  // pos_ is at the 'u' of "\uXXXX"
+  if (pos_ + 5 > input_.size()) ThrowUnterminatedString(string_start);
+
+  std::uint32_t code_unit = 0;
+  for (std::size_t i = pos_ + 1; i < pos_ + 5; i++) {
+    char ch = input_[i];
+    std::uint32_t digit;
+    if (ch >= '0' && ch <= '9') {
+      digit = ch - '0';
+    } else if ((ch | 0x20) >= 'a' && (ch | 0x20) <= 'f') {
+      digit = (ch | 0x20) - 'a' + 10;
+    } else {
+      std::stringstream ssInvalidEscMsg;
+      ssInvalidEscMsg << "Escape \"\\" << input_.substr(pos_, 5)
+                      << "\" needs four hex digits at " << Locate(pos_ - 1);
+      throw WrongLexingException(ssInvalidEscMsg.str());
     }
+    code_unit = code_unit << 4 | digit;
+  }
 
-    // If it is the ending double quote of the string
-    if (text_queue_.front() == '\"' && str_val.back() != '\\') break;
+  pos_ += 5;
+  return code_unit;
+}
+
+std::uint32_t Lexer::ReadEscape(std::size_t string_start) {
+  // pos_ is at the backslash
+  if (pos_ + 1 >= input_.size()) ThrowUnterminatedString(string_start);
+
+  std::size_t escape_start = pos_;
+  pos_++;
+  switch (Current()) {
+    case 'n':
+      pos_++;
+      return '\n';
+    case 't':
+      pos_++;
+      return '\t';
+    case '\\':
+    case '\"':
+      pos_++;
+      return input_[pos_ - 1];
+    case 'u':
+      break;
+    default: {
+      std::stringstream ssInvalidEscMsg;
+      ssInvalidEscMsg << "Unknown escape \"\\" << Current() << "\" at "
+                      << Locate(escape_start);
+      throw WrongLexingException(ssInvalidEscMsg.str());
+    }
+  }
 
-    // If it is the double quote inside the string
-    if (text_queue_.front() == '\"' && str_val.back() == '\\')
-      str_val.pop_back();
+  std::uint32_t code_point = ReadHex4(string_start);
+  bool valid = code_point < 0xD800 || code_point > 0xDFFF;
 
-    str_val.push_back(text_queue_.front());
-    text_queue_.pop();
+  // A code point past U+FFFF is written as a UTF-16 surrogate pair
+  if (code_point >= 0xD800 && code_point <= 0xDBFF) {
+    std::string_view next = input_.substr(pos_, 2);
+    if (next.empty() || next == "\\") ThrowUnterminatedString(string_start);
+
+    if (next == "\\u") {
+      pos_++;
+      std::uint32_t low = ReadHex4(string_start);
+      valid = low >= 0xDC00 && low <= 0xDFFF;
+      code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+    }
   }
 
-  text_queue_.pop();
+  if (!valid) {
+    std::stringstream ssInvalidEscMsg;
+    ssInvalidEscMsg << "Escape \""
+                    << input_.substr(escape_start, pos_ - escape_start)
+                    << "\" is an unpaired UTF-16 surrogate at "
+                    << Locate(escape_start);
+    throw WrongLexingException(ssInvalidEscMsg.str());
+  }
 
-  return str_val;
+  return code_point;
 }
 
-std::string Lexer::ReadNum() {
-  std::string num_val;
+std::string_view Lexer::ReadStr(std::string *decoded) {
+  if (Current() != '\"')
+    throw WrongLexingException("Double quote for string not found");
+  std::size_t start = pos_;
 
-  // Used to check if there is double dot inside the number.
-  bool isDecimal = false;
-  while (!text_queue_.empty() &&
-         (std::isdigit(text_queue_.front()) || text_queue_.front() == '.')) {
-    if (isDecimal && text_queue_.front() == '.') {
-      std::stringstream ssInvalidStrMsg;
-      ssInvalidStrMsg << "Double value can't have two dot. Error in Original \""
-                      << num_val << "\" when adding \"" << text_queue_.front()
-                      << "\"";
-      throw WrongLexingException(ssInvalidStrMsg.str());
-    }
-    num_val.push_back(text_queue_.front());
-    text_queue_.pop();
-  };
+  // Skip the double quote (starting point of the string)
+  pos_++;
 
-  return num_val;
-}
+  std::size_t run_start = pos_;
 
-std::string Lexer::ReadLiteral() {
-  std::string str_val;
+  while (true) {
+    // Jump over the plain characters, only '"' and '\\' need a closer look
+    pos_ = FindQuoteOrBackslash(input_, pos_);
 
-  if (!isalpha(text_queue_.front()))
-    throw WrongLexingException("Alphabet not found");
-  str_val.push_back(text_queue_.front());
-  text_queue_.pop();
+    if (pos_ >= input_.size()) ThrowUnterminatedString(start);
 
-  while (!text_queue_.empty() && isalnum(text_queue_.front())) {
-    str_val.push_back(text_queue_.front());
-    text_queue_.pop();
+    // If it is the ending double quote of the string
+    if (Current() == '\"') break;
+
+    // Copy the run before the escape at once, then decode the escape
+    std::string_view run = input_.substr(run_start, pos_ - run_start);
+    std::uint32_t code_point = ReadEscape(start);
+    if (decoded != nullptr) {
+      decoded->append(run);
+      AppendUtf8(code_point, decoded);
+    }
+    run_start = pos_;
   }
 
+  // Without escapes the string is its source text, nothing is copied
+  if (decoded != nullptr && !decoded->empty())
+    decoded->append(input_.substr(run_start, pos_ - run_start));
+
+  // Escapes are ASCII, so the source range is valid UTF-8 exactly when the
+  // string is
+  std::size_t invalid = FindInvalidUtf8(input_.substr(0, pos_), start + 1);
+  if (invalid < pos_) ThrowInvalidUtf8(invalid);
+
+  std::string_view str_val = input_.substr(start + 1, pos_ - start - 1);
+
+  // Skip the ending double quote
+  pos_++;
+
   return str_val;
 }
 
-std::string Lexer::ReadOp() {
-  std::string allowed_op = "(){}!=+-*/";
-  if (allowed_op.find(text_queue_.front()) == std::string::npos)
-    throw WrongLexingException("Allowed Operator not found");
+void Lexer::SkipDigitRun() {
+  while (true) {
+    pos_ = SkipDigits(input_, pos_);
+    if (Current() != '_') break;
+    pos_++;
+  }
+}
+
+double Lexer::ReadNum() {
+  std::size_t start = pos_;
+  char prefix = pos_ + 1 < input_.size() ? input_[pos_ + 1] | 0x20 : '\0';
+
+  if (Current() == '0' && (prefix == 'x' || prefix == 'b')) {
+    // Take every letter and digit, so a bad digit ("0b12", "0xFG") is an
+    // error rather than the start of the next token
+    pos_ += 2;
+    while (true) {
+      pos_ = SkipIdentifier(input_, pos_);
+      if (Current() != '_') break;
+      pos_++;
+    }
+  } else {
+    SkipDigitRun();
+
+    // Used to check if there is double dot inside the number.
+    bool isDecimal = false;
+    while (Current() == '.') {
+      if (isDecimal) {
+        std::stringstream ssInvalidStrMsg;
+        ssInvalidStrMsg
+            << "Double value can't have two dot. Error in Original \""
+            << input_.substr(start, pos_ - start) << "\" when adding \""
+            << Current() << "\" at " << Locate(pos_);
+        throw WrongLexingException(ssInvalidStrMsg.str());
+      }
+      isDecimal = true;
+      pos_++;
+      SkipDigitRun();
+    }
 
-  std::string op_str;
-  op_str.push_back(text_queue_.front());
-  text_queue_.pop();
+    // An exponent needs digits, otherwise the 'e' starts an identifier
+    if ((Current() | 0x20) == 'e') {
+      std::size_t digits = pos_ + 1;
+      if (digits < input_.size() &&
+          (input_[digits] == '+' || input_[digits] == '-')) {
+        digits++;
+      }
+      if (digits < input_.size() &&
+          ClassifyByte(input_[digits]) == CharClass::DIGIT) {
+        pos_ = digits;
+        SkipDigitRun();
+      }
+    }
+  }
 
-  bool isMultiplePunctuationAllowed = Operator(op_str).IsOverloadable();
+  double number;
+  if (!DecodeNumberLiteral(input_.substr(start, pos_ - start), &number)) {
+    std::stringstream ssInvalidNumMsg;
+    ssInvalidNumMsg << "Invalid number \"" << input_.substr(start, pos_ - start)
+                    << "\" at " << Locate(start);
+    throw WrongLexingException(ssInvalidNumMsg.str());
+  }
 
-  // This design will let 1-2 chars of punct in one operator.
-  if (!isMultiplePunctuationAllowed) return op_str;
+  return number;
+}
 
-  op_str.push_back(text_queue_.front());
+std::uint32_t Lexer::ReadCodePoint() {
+  std::uint32_t code_point;
+  std::size_t length = DecodeUtf8(input_, pos_, &code_point);
+  if (length == 0) ThrowInvalidUtf8(pos_);
+  pos_ += length;
+  return code_point;
+}
 
-  // Constructor validate Operator punctuation. if err, remove the operator
-  try {
-    Operator optest(op_str);
-    text_queue_.pop();
-  } catch (InvalidOperatorTypeException) {
-    op_str.pop_back();
+std::string_view Lexer::ReadLiteral() {
+  std::size_t start = pos_;
+
+  if (ClassifyByte(Current()) == CharClass::LETTER) {
+    pos_++;
+  } else if (!IsXidStart(ReadCodePoint())) {
+    std::stringstream ssInvalidIdMsg;
+    ssInvalidIdMsg << "Character \""
+                   << input_.substr(start, pos_ - start) << "\" at "
+                   << Locate(start) << " can't start an identifier";
+    throw WrongLexingException(ssInvalidIdMsg.str());
   }
 
-  return op_str;
+  while (true) {
+    // ASCII letters and digits in one call, then at most one non ASCII
+    // character per iteration
+    pos_ = SkipIdentifier(input_, pos_);
+    if (static_cast<unsigned char>(Current()) < 0x80) break;
+
+    std::size_t char_start = pos_;
+    if (!IsXidContinue(ReadCodePoint())) {
+      pos_ = char_start;
+      break;
+    }
+  }
+
+  return input_.substr(start, pos_ - start);
 }
 
-std::string Lexer::ReadWhitespace() {
-  std::string str_val;
-  if (!isspace(text_queue_.front()))
-    throw WrongLexingException("Whitespace not found");
+const OperatorInfo &Lexer::ReadOp() {
+  // Longest operator starting at the cursor, e.g. "!=" before "!"
+  const OperatorInfo *info = operators_->Match(input_.substr(pos_));
+  if (info == nullptr) throw WrongLexingException("Allowed Operator not found");
 
-  while (!text_queue_.empty() && isspace(text_queue_.front())) {
-    str_val.push_back(text_queue_.front());
-    text_queue_.pop();
-  }
+  pos_ += info->text.size();
 
-  return str_val;
+  return *info;
 }
 
-TokenType Lexer::GetReservedKeywordTokenType(std::string keyword) const {
-  if (keyword == "func") return TokenType::FUNCTION;
-  if (keyword == "if") return TokenType::IF;
-  if (keyword == "set") return TokenType::SET;
-  if (keyword == "true") return TokenType::TRUE;
-  if (keyword == "false") return TokenType::FALSE;
-  if (keyword == "for") return TokenType::FOR;
-  if (keyword == "return") return TokenType::RETURN;
-  if (keyword == "null") return TokenType::NULLABLE;
+std::string_view Lexer::ReadWhitespace() {
+  std::size_t start = pos_;
+  if (ClassifyByte(Current()) != CharClass::WHITESPACE)
+    throw WrongLexingException("Whitespace not found");
+
+  pos_ = SkipWhitespace(input_, pos_);
+
+  return input_.substr(start, pos_ - start);
+}
 
-  return TokenType::INVALID;
+TokenType Lexer::GetReservedKeywordTokenType(std::string_view keyword) const {
+  return LookupReservedKeyword(keyword);
 }
 
-TokenPtr Lexer::NextToken() {
-  TokenPtr tok_ptr;
+Lexeme Lexer::Scan() {
+  if (!keep_whitespace_) pos_ = SkipWhitespace(input_, pos_);
+
+  Lexeme lexeme;
+  lexeme.op_type = OperatorType::INVALID;
+  lexeme.number = 0;
+  lexeme.offset = static_cast<std::uint32_t>(pos_);
 
-  TokenType tok_type;
-  // Check whether it is for literal or number
-  std::string text_val;
+  LexAction action = StartAction(Current());
+  // Registered operators may start with bytes no built-in token starts with
+  if (action == LexAction::ERROR && operators_->StartsOperator(Current()))
+    action = LexAction::OPERATOR;
 
-  switch (static_cast<int>(text_queue_.front())) {
-    case 0:  // NULL terminator
-      tok_ptr = GenerateToken("", TokenType::EOL, OperatorPtr(nullptr));
+  switch (action) {
+    case LexAction::EOL:
+      lexeme.tok_type = TokenType::EOL;
       break;
-    case 9:   // \t
-    case 32:  // Space
-      tok_ptr = GenerateToken(ReadWhitespace(), TokenType::WHITESPACE,
-                              OperatorPtr(nullptr));
+    case LexAction::WHITESPACE:
+      ReadWhitespace();
+      lexeme.tok_type = TokenType::WHITESPACE;
       break;
-    case 33:   // !
-    case 40:   // (
-    case 41:   // )
-    case 42:   // *
-    case 43:   // +
-    case 45:   // -
-    case 47:   // /
-    case 61:   // =
-    case 123:  // {
-    case 125:  // }
-      text_val = ReadOp();
-      tok_ptr =
-          GenerateToken(text_val, TokenType::OPERATOR, GenerateOp(text_val));
+    case LexAction::OPERATOR:
+      lexeme.tok_type = TokenType::OPERATOR;
+      lexeme.op_type = ReadOp().op_type;
       break;
-    case 34:  // "
-      tok_ptr =
-          GenerateToken(ReadStr(), TokenType::STRING, OperatorPtr(nullptr));
+    case LexAction::STRING:
+      lexeme.tok_type = TokenType::STRING;
+      ReadStr(decode_strings_ ? &lexeme.decoded : nullptr);
       break;
-    case 48 ... 57:  // 0-9
-      // Validate if it is number
-      tok_ptr =
-          GenerateToken(ReadNum(), TokenType::NUMBER, OperatorPtr(nullptr));
+    case LexAction::NUMBER:
+      // Validate and decode the number
+      lexeme.number = ReadNum();
+      lexeme.tok_type = TokenType::NUMBER;
       break;
-    case 65 ... 90:   // A-Z
-    case 97 ... 122:  // a-z
+    case LexAction::IDENTIFIER:
       // Validate reserved string or if it is identifier
-      text_val = ReadLiteral();
-      tok_type = GetReservedKeywordTokenType(text_val);
-      if (tok_type == TokenType::INVALID) {
-        tok_ptr = GenerateToken(text_val, TokenType::IDENTIFIER,
-                                OperatorPtr(nullptr));
-      } else {
-        tok_ptr = GenerateToken(text_val, tok_type, OperatorPtr(nullptr));
-      }
+      lexeme.tok_type = GetReservedKeywordTokenType(ReadLiteral());
+      if (lexeme.tok_type == TokenType::INVALID)
+        lexeme.tok_type = TokenType::IDENTIFIER;
       break;
-    default:
+    case LexAction::ERROR:
       std::stringstream ssInvalidTokMsg;
-      ssInvalidTokMsg << "Token: \'" << text_queue_.front()
-                      << "\' is not allowed";
+      ssInvalidTokMsg << "Token: \'" << Current() << "\' at " << Locate(pos_)
+                      << " is not allowed";
       throw WrongLexingException(ssInvalidTokMsg.str());
   }
 
-  return tok_ptr;
+  lexeme.length = static_cast<std::uint32_t>(pos_) - lexeme.offset;
+  return lexeme;
+}
+
+TokenPtr Lexer::NextToken() { return ToToken(Scan()); }
+
+TokenPtr Lexer::ToToken(const Lexeme &lexeme,
+                        std::uint64_t base_offset) const {
+  std::uint32_t offset =
+      static_cast<std::uint32_t>(base_offset + lexeme.offset);
+  std::string_view text_val = input_.substr(lexeme.offset, lexeme.length);
+  if (lexeme.tok_type == TokenType::STRING) {
+    // Only strings with escapes have decoded text, the others are their
+    // source without the quotes
+    if (lexeme.decoded.empty()) {
+      text_val = text_val.substr(1, lexeme.length - 2);
+    } else {
+      text_val = lexeme.decoded;
+    }
+    return GenerateToken(text_val, lexeme.tok_type, OperatorPtr(nullptr),
+                         offset);
+  }
+
+  if (lexeme.tok_type == TokenType::NUMBER)
+    return GenerateNumberToken(text_val, lexeme.number, offset);
+
+  if (lexeme.tok_type == TokenType::OPERATOR) {
+    const OperatorInfo &info = *operators_->Find(lexeme.op_type);
+    return GenerateToken(text_val, lexeme.tok_type, GenerateOp(info), offset);
+  }
+
+  return GenerateToken(text_val, lexeme.tok_type, OperatorPtr(nullptr), offset);
+}
+
+namespace {
+
+/**
+ * @brief Append a scanned token to a TokenBuffer
+ * @param tokens the buffer to append to
+ * @param lexeme the scanned token (its decoded text is moved from)
+ */
+void AppendLexeme(TokenBuffer &tokens, Lexeme &lexeme) {
+  // A string literal without escapes is exactly its source range minus the
+  // quotes, only the escaped ones have decoded text to keep aside
+  if (lexeme.tok_type == TokenType::NUMBER) {
+    tokens.AppendNumber(lexeme.offset, lexeme.length, lexeme.number);
+  } else if (lexeme.tok_type == TokenType::STRING &&
+             !lexeme.decoded.empty()) {
+    tokens.AppendDecoded(lexeme.tok_type, lexeme.offset, lexeme.length,
+                         std::move(lexeme.decoded));
+  } else {
+    tokens.Append(lexeme.tok_type, lexeme.offset, lexeme.length,
+                  lexeme.op_type);
+  }
+}
+
+/**
+ * @brief Tokens lexed by a worker of Lexer::TokenizeParallel from a chunk of
+ * the input
+ */
+struct LexedChunk {
+  std::size_t begin;
+  std::size_t end;
+  TokenBuffer tokens;
+  // Offset of the byte after the last token
+  std::size_t exit;
+  // Set if lexing failed before the end of the chunk, tokens holds the tokens
+  // before the error
+  std::exception_ptr error;
+};
+
+/**
+ * @brief Lex the tokens starting in [chunk.begin, chunk.end), speculating
+ * that a token starts at chunk.begin
+ * @param lexer a copy of the Lexer over the whole input (a token may end past
+ * the chunk), with its settings
+ * @param chunk the chunk to lex, receives the tokens
+ */
+void LexChunk(Lexer lexer, LexedChunk &chunk) {
+  lexer.Seek(chunk.begin);
+  chunk.tokens = lexer.EmptyBuffer();
+  std::string_view input = chunk.tokens.Source();
+
+  try {
+    // The last chunk runs up to and including the EOL token
+    while (true) {
+      Lexeme lexeme = lexer.Scan();
+      if (chunk.end != input.size() && lexeme.offset >= chunk.end) break;
+      AppendLexeme(chunk.tokens, lexeme);
+      if (lexeme.tok_type == TokenType::EOL) break;
+    }
+  } catch (...) {
+    chunk.error = std::current_exception();
+  }
+
+  std::size_t count = chunk.tokens.Size();
+  chunk.exit = count == 0 ? chunk.begin
+                          : chunk.tokens.Offset(count - 1) +
+                                chunk.tokens.Length(count - 1);
+}
+
+}  // namespace
+
+TokenBuffer Lexer::EmptyBuffer() const {
+  TokenBuffer tokens;
+  if (owned_input_) {
+    tokens = TokenBuffer(owned_input_);
+  } else if (file_ptr_) {
+    tokens = TokenBuffer(input_, file_ptr_);
+  } else {
+    tokens = TokenBuffer(input_);
+  }
+  tokens.SetOperators(*operators_);
+  return tokens;
+}
+
+void Lexer::Pull(TokenBuffer *tokens) {
+  Lexeme lexeme = Scan();
+  AppendLexeme(*tokens, lexeme);
+}
+
+TokenBuffer Lexer::Tokenize() {
+  TokenBuffer tokens = EmptyBuffer();
+
+  Lexeme lexeme;
+  do {
+    lexeme = Scan();
+    AppendLexeme(tokens, lexeme);
+  } while (lexeme.tok_type != TokenType::EOL);
+
+  return tokens;
+}
+
+TokenBuffer Lexer::Relex(const TokenBuffer &previous, const SourceEdit &edit) {
+  std::size_t old_size = previous.Source().size();
+  if (previous.Size() == 0 || edit.offset > old_size ||
+      edit.removed > old_size - edit.offset ||
+      old_size - edit.removed + edit.inserted != input_.size()) {
+    std::stringstream ss_edit_err_msg;
+    ss_edit_err_msg << "Edit at " << edit.offset << " (-" << edit.removed
+                    << " +" << edit.inserted
+                    << ") does not match the previous tokens";
+    throw LexLineOutOfBoundException(ss_edit_err_msg.str());
+  }
+
+  std::int64_t shift = static_cast<std::int64_t>(edit.inserted) -
+                       static_cast<std::int64_t>(edit.removed);
+  std::size_t edit_end = edit.offset + edit.inserted;
+
+  // The lexer looks at most Lookahead() bytes past a token, so the tokens
+  // ending further before the edit are unchanged. Restart after the last of
+  // them, the next token (at least the EOL token at the end of the source)
+  // may see the edit.
+  std::size_t restart = 0;
+  std::size_t restart_end = previous.Size() - 1;
+  while (restart < restart_end) {
+    std::size_t mid = restart + (restart_end - restart) / 2;
+    if (previous.Offset(mid) + previous.Length(mid) + Lookahead() <=
+        edit.offset) {
+      restart = mid + 1;
+    } else {
+      restart_end = mid;
+    }
+  }
+
+  // The unchanged tokens share the chunks of the previous buffer, so only
+  // the tokens around the edit are lexed or copied
+  TokenBuffer tokens = EmptyBuffer();
+  tokens.Reserve(previous.Size());
+  tokens.AppendRange(previous, 0, restart, 0);
+
+  // Skipped whitespace between the tokens may have been edited too
+  pos_ = restart == 0 ? 0
+                      : previous.Offset(restart - 1) +
+                            previous.Length(restart - 1);
+  std::size_t old_index = restart;
+  while (true) {
+    Lexeme lexeme = Scan();
+
+    // Past the edit the source is the same as before, so once a token starts
+    // where a previous token started both token streams agree to the end
+    if (lexeme.offset >= edit_end) {
+      std::size_t old_offset = static_cast<std::size_t>(lexeme.offset - shift);
+      while (old_index < previous.Size() &&
+             previous.Offset(old_index) < old_offset) {
+        old_index++;
+      }
+
+      if (old_index < previous.Size() &&
+          previous.Offset(old_index) == old_offset) {
+        tokens.AppendRange(previous, old_index, previous.Size(), shift);
+        pos_ = input_.size();
+        return tokens;
+      }
+    }
+
+    AppendLexeme(tokens, lexeme);
+    if (lexeme.tok_type == TokenType::EOL) return tokens;
+  }
+}
+
+TokenBuffer Lexer::TokenizeParallel(unsigned thread_count,
+                                    std::size_t min_chunk_size) {
+  if (thread_count == 0) thread_count = std::thread::hardware_concurrency();
+  if (min_chunk_size == 0) min_chunk_size = 1;
+
+  std::size_t rest = input_.size() - std::min(pos_, input_.size());
+  std::size_t chunk_count =
+      std::min<std::size_t>(thread_count, rest / min_chunk_size);
+  if (chunk_count <= 1) return Tokenize();
+
+  // Cut the input after the first newline past each equal share, where a
+  // token almost always starts
+  std::vector<LexedChunk> chunks;
+  std::size_t begin = pos_;
+  for (std::size_t i = 1; i <= chunk_count && begin < input_.size(); i++) {
+    std::size_t end = input_.size();
+    std::size_t target = pos_ + rest / chunk_count * i;
+    if (i < chunk_count && target < input_.size()) {
+      const void *newline =
+          std::memchr(input_.data() + target, '\n', input_.size() - target);
+      if (newline != nullptr)
+        end = static_cast<const char *>(newline) - input_.data() + 1;
+    }
+    chunks.push_back({begin, end, TokenBuffer(), 0, nullptr});
+    begin = end;
+  }
+
+  std::vector<std::thread> workers;
+  workers.reserve(chunks.size() - 1);
+  for (std::size_t i = 1; i < chunks.size(); i++) {
+    try {
+      workers.emplace_back(LexChunk, *this, std::ref(chunks[i]));
+    } catch (const std::system_error &) {
+      // No thread left, lex the remaining chunks on this one (the started
+      // workers are still joined below)
+      for (std::size_t j = i; j < chunks.size(); j++)
+        LexChunk(*this, chunks[j]);
+      break;
+    }
+  }
+  LexChunk(*this, chunks[0]);
+  for (std::thread &worker : workers) worker.join();
+
+  TokenBuffer tokens = EmptyBuffer();
+  std::size_t total_size = 0;
+  for (const LexedChunk &chunk : chunks) total_size += chunk.tokens.Size();
+  tokens.Reserve(total_size);
+
+  // Stitch the chunks together. A chunk whose first token is not where the
+  // previous chunk stopped (its start was inside a string literal or a token
+  // running over the newline) is lexed again from there until it meets one
+  // of its speculative tokens, after which both agree.
+  std::size_t expected = pos_;
+  for (const LexedChunk &chunk : chunks) {
+    std::size_t first = 0;
+    bool in_sync = false;
+    pos_ = expected;
+    while (true) {
+      std::size_t start = pos_;
+      Lexeme lexeme = Scan();
+      if (chunk.end != input_.size() && lexeme.offset >= chunk.end) {
+        pos_ = start;
+        break;
+      }
+
+      while (first < chunk.tokens.Size() &&
+             chunk.tokens.Offset(first) < lexeme.offset) {
+        first++;
+      }
+      if (first < chunk.tokens.Size() &&
+          chunk.tokens.Offset(first) == lexeme.offset) {
+        in_sync = true;
+        break;
+      }
+
+      AppendLexeme(tokens, lexeme);
+      if (lexeme.tok_type == TokenType::EOL) return tokens;
+    }
+
+    // The speculative tokens are right from the meeting point on, including
+    // an error they ran into
+    if (in_sync) {
+      tokens.AppendRange(chunk.tokens, first, chunk.tokens.Size(), 0);
+      if (chunk.error) std::rethrow_exception(chunk.error);
+      if (chunk.tokens.Type(chunk.tokens.Size() - 1) == TokenType::EOL)
+        return tokens;
+      pos_ = chunk.exit;
+    }
+
+    expected = pos_;
+  }
+
+  return tokens;
 }
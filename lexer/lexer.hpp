@@ -5,71 +5,328 @@
 #ifndef LEXER_H
 #define LEXER_H
 
-#include <queue>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <string>
-#include <vector>
+#include <string_view>
 
 #include "file.hpp"
+#include "line_table.hpp"
 #include "operator.hpp"
+#include "operator_registry.hpp"
 #include "token.hpp"
+#include "token_buffer.hpp"
+#include "token_source.hpp"
 
 /**
- * @brief Lexer class to parse the input string
+ * @brief A token as scanned by the Lexer, before it is turned into a Token or
+ * appended to a TokenBuffer
  */
-class Lexer {
+struct Lexeme {
+  TokenType tok_type;
+  OperatorType op_type;
+  std::uint32_t offset;
+  std::uint32_t length;
+  // Value of a number literal
+  double number;
+  // Text of a string literal with escapes applied (empty if it has no
+  // escapes, its text is then the source range without the quotes)
+  std::string decoded;
+};
+
+/**
+ * @brief A change of the source text: `removed` bytes at `offset` were
+ * replaced by `inserted` bytes
+ */
+struct SourceEdit {
+  std::size_t offset;
+  std::size_t removed;
+  std::size_t inserted;
+};
+
+/**
+ * @brief Lexer class to parse the input string. As a TokenSource it feeds the
+ * Parser one token at a time.
+ */
+class Lexer : public TokenSource {
  private:
   FilePtr file_ptr_;
-  std::queue<char> text_queue_;
-  int line_;
+  // Only used when the lexer owns its input (std::string constructor).
+  // input_ always points at the text being scanned.
+  std::shared_ptr<const std::string> owned_input_;
+  std::string_view input_;
+  std::size_t pos_;
+  // Whether whitespace is returned as TokenType::WHITESPACE tokens or
+  // skipped (left in the gaps between tokens, see TokenBuffer::LeadingTrivia)
+  bool keep_whitespace_;
+  // Whether escaped string literals are decoded into Lexeme::decoded or
+  // only validated
+  bool decode_strings_;
+  // The operators matched by ReadOp
+  const OperatorRegistry *operators_;
+  // Line and column of the first input byte in the whole source, for error
+  // messages when the input is a window of it
+  SourceLocation base_location_;
+
+  /**
+   * @brief Get the character under the cursor
+   * @return char the current character, or '\0' if the cursor reached the end
+   */
+  char Current() const;
 
   /**
-   * @brief Lex the string between the quotation marks
-   * @return std::string the string between the quotation marks
+   * @brief Get the line and column of an input byte for an error message
+   * (scans the input for newlines, only call it on errors)
+   * @param offset the byte offset in the input
+   * @return SourceLocation the line and column of the byte
    */
-  std::string ReadStr();
+  SourceLocation Locate(std::size_t offset) const;
+
+  /**
+   * @brief Lex the string between the quotation marks, decoding the escapes
+   * \\n, \\t, \\\\, \\" and \\uXXXX (UTF-8 encoded, surrogate pairs joined)
+   * @param decoded receives the decoded string if it has escapes, stays empty
+   * otherwise (nullptr to only validate the escapes)
+   * @return std::string_view the source text between the quotation marks
+   */
+  std::string_view ReadStr(std::string *decoded);
+
+  /**
+   * @brief Decode the escape sequence at the cursor (a backslash)
+   * @param string_start the offset of the string's opening quotation mark
+   * @return std::uint32_t the code point of the escaped character
+   */
+  std::uint32_t ReadEscape(std::size_t string_start);
+
+  /**
+   * @brief Read the four hex digits of a \\u escape (cursor on the 'u')
+   * @param string_start the offset of the string's opening quotation mark
+   * @return std::uint32_t the UTF-16 code unit
+   */
+  std::uint32_t ReadHex4(std::size_t string_start);
+
   /**
-   * @brief Lex the number
-   * @return std::string lex number in string format
+   * @brief Report a string without ending quotation mark. The cursor is moved
+   * to the end of the input, where more input could complete the string.
+   * @param start the offset of the string's opening quotation mark
    */
-  std::string ReadNum();
+  [[noreturn]] void ThrowUnterminatedString(std::size_t start);
   /**
-   * @brief Lex the literal (variable name, function name, etc.)
-   * @return std::string lex literal
+   * @brief Report an invalid UTF-8 sequence. A sequence cut by the end of the
+   * input moves the cursor to the end like ThrowUnterminatedString.
+   * @param offset the offset of the sequence's first byte
    */
-  std::string ReadLiteral();
+  [[noreturn]] void ThrowInvalidUtf8(std::size_t offset);
 
   /**
-   * @brief Lex the operator
-   * @return std::string lex operator
+   * @brief Lex and decode the number (decimal with optional fraction and
+   * exponent, 0x hexadecimal or 0b binary, with '_' digit separators)
+   * @return double the value of the number
    */
-  std::string ReadOp();
+  double ReadNum();
+
+  /**
+   * @brief Skip a run of digits and '_' digit separators
+   */
+  void SkipDigitRun();
+  /**
+   * @brief Lex the literal (variable name, function name, etc.): an ASCII
+   * letter or XID_Start character, followed by ASCII letters, digits and non
+   * ASCII XID_Continue characters
+   * @return std::string_view lex literal, referring to the input text
+   */
+  std::string_view ReadLiteral();
+  /**
+   * @brief Decode the UTF-8 character under the cursor and move past it
+   * @return std::uint32_t the code point of the character
+   */
+  std::uint32_t ReadCodePoint();
+
+  /**
+   * @brief Lex the longest operator at the cursor
+   * @return const OperatorInfo & the operator's entry in the OperatorRegistry
+   */
+  const OperatorInfo &ReadOp();
 
   /**
    * @brief Lex the whitespace
-   * @return std::string lex whitespace
+   * @return std::string_view lex whitespace, referring to the input text
    */
-  std::string ReadWhitespace();
+  std::string_view ReadWhitespace();
 
  public:
   /**
-   * @brief Construct a new Lexer object
+   * @brief Number of bytes, starting at the end of a token, the lexer may look
+   * at to decide where the token ends ("1e+" is the number 1 unless a digit
+   * follows)
+   */
+  static constexpr std::size_t kMaxLookahead = 3;
+
+  /**
+   * @brief Construct a new Lexer object which owns a copy of the input
    * @param input the input string to be lexed
    */
   Lexer(std::string input);
+  /**
+   * @brief Construct a new Lexer object which borrows the input buffer without
+   * copying it
+   * @pre The buffer must outlive the Lexer
+   * @param data the beginning of the input buffer to be lexed
+   * @param length the number of bytes in the input buffer
+   */
+  Lexer(const char *data, std::size_t length);
   Lexer(FilePtr file_ptr);
   ~Lexer();
 
   /**
    * @brief Check if the keyword is a reserved keyword
+   * @param keyword the identifier to classify
    * @return TokenType the token type of the reserved keyword, else TokenType::INVALID
    */
-  TokenType GetReservedKeywordTokenType(std::string keyword) const;
+  TokenType GetReservedKeywordTokenType(std::string_view keyword) const;
 
   /**
    * @brief Get the next token in the input string using the Read... functions
    * @return TokenPtr the next token in the input string
    */
   TokenPtr NextToken();
+
+  /**
+   * @brief Build an empty TokenBuffer over the input, sharing the input (or
+   * the File) when the Lexer owns it
+   * @return TokenBuffer the empty buffer
+   */
+  TokenBuffer EmptyBuffer() const override;
+
+  /**
+   * @brief Lex the next token into a buffer built by EmptyBuffer()
+   * (TokenType::EOL again and again at the end of the input)
+   * @param tokens the buffer to append to
+   */
+  void Pull(TokenBuffer *tokens) override;
+
+  /**
+   * @brief Scan the next token using the Read... functions, without building
+   * a Token
+   * @return Lexeme the type and source range of the next token
+   */
+  Lexeme Scan();
+
+  /**
+   * @brief Build a Token from a Lexeme scanned by this Lexer
+   * @param lexeme the scanned token
+   * @param base_offset added to the token's offset, when the input is a
+   * window of a larger source (the offset wraps past 4 GiB)
+   * @return TokenPtr the token
+   */
+  TokenPtr ToToken(const Lexeme &lexeme, std::uint64_t base_offset = 0) const;
+
+  /**
+   * @brief Choose whether whitespace is lexed into TokenType::WHITESPACE
+   * tokens (the default) or skipped. The parser ignores whitespace, so
+   * skipping it halves the tokens it walks over.
+   * @param keep_whitespace true to return whitespace tokens
+   */
+  void SetKeepWhitespace(bool keep_whitespace) {
+    keep_whitespace_ = keep_whitespace;
+  }
+
+  /**
+   * @brief Choose whether string literals with escapes are decoded into
+   * Lexeme::decoded (the default) or only validated, so scanning never
+   * allocates (see Recognizer)
+   * @param decode_strings true to decode the escapes
+   */
+  void SetDecodeStrings(bool decode_strings) {
+    decode_strings_ = decode_strings;
+  }
+
+  /**
+   * @brief Set where the input starts in the whole source, when it is a
+   * window of it (see StreamLexer), so error messages give the line and
+   * column in the whole source
+   * @param location the line and column of the first input byte
+   */
+  void SetBaseLocation(SourceLocation location) { base_location_ = location; }
+
+  /**
+   * @brief Choose the operators the lexer matches (by default
+   * OperatorRegistry::Builtin())
+   * @pre The registry must outlive the Lexer
+   * @param operators the registry of the operators, including the infix
+   * operators registered at runtime
+   */
+  void SetOperators(const OperatorRegistry &operators) {
+    operators_ = &operators;
+  }
+
+  /**
+   * @brief Get the number of bytes past the end of a token the lexer may look
+   * at: kMaxLookahead, or more when a long operator is registered (maximal
+   * munch looks for its remaining bytes)
+   * @return std::size_t the lookahead in bytes
+   */
+  std::size_t Lookahead() const {
+    return std::max(kMaxLookahead, operators_->MaxLength() - 1);
+  }
+
+  /**
+   * @brief Get the position of the cursor in the input
+   * @return std::size_t the byte offset of the next token
+   */
+  std::size_t Position() const { return pos_; }
+
+  /**
+   * @brief Move the cursor, the next token is scanned from there
+   * @param pos the byte offset to continue lexing from
+   */
+  void Seek(std::size_t pos) { pos_ = pos; }
+
+  /**
+   * @brief Lex the rest of the input into a TokenBuffer (up to and including
+   * the TokenType::EOL token)
+   * @return TokenBuffer the tokens, which refer back into the input. The
+   * buffer shares the input (or the File) when the Lexer owns it, otherwise
+   * the borrowed input must outlive the buffer.
+   */
+  TokenBuffer Tokenize();
+
+  /**
+   * @brief Lex the input after an edit, reusing the tokens of the source
+   * before the edit. Only the tokens from the last one unaffected by the edit
+   * up to the first one starting where a previous token started (after the
+   * edit) are lexed again, the others share the chunks of the previous
+   * buffer (see TokenBuffer::AppendRange). The time depends on the size of
+   * the edit and the number of chunks, not on the number of tokens.
+   * @param previous the tokens of the whole source before the edit (as
+   * returned by Tokenize() or Relex() with the same whitespace setting)
+   * @param edit the change which turned the previous source into the input
+   * @return TokenBuffer the tokens of the whole input, like Tokenize()
+   */
+  TokenBuffer Relex(const TokenBuffer &previous, const SourceEdit &edit);
+
+  /**
+   * @brief Default minimum number of bytes lexed by each thread of
+   * TokenizeParallel()
+   */
+  static constexpr std::size_t kMinParallelChunkSize = 1024 * 1024;
+
+  /**
+   * @brief Lex the rest of the input like Tokenize(), splitting it at
+   * newlines into chunks lexed on their own threads. Each chunk is lexed
+   * assuming a token starts at its beginning; chunks starting inside a token
+   * (e.g. a multi-line string literal) are fixed up while concatenating.
+   * @param thread_count the maximum number of threads, 0 for one per hardware
+   * thread
+   * @param min_chunk_size the minimum number of bytes per thread, smaller
+   * inputs use fewer threads
+   * @return TokenBuffer the tokens, same as Tokenize()
+   */
+  TokenBuffer TokenizeParallel(unsigned thread_count = 0,
+                               std::size_t min_chunk_size =
+                                   kMinParallelChunkSize);
 };
 
 /**
@@ -0,0 +1,42 @@
+#include "line_table.hpp"
+
+#include <algorithm>
+
+#include "scan.hpp"
+
+LineTable::LineTable(std::string_view source) : source_(source) {}
+
+void LineTable::Build() const {
+  if (!line_starts_.empty()) return;
+
+  line_starts_.push_back(0);
+  CollectLineStarts(source_, &line_starts_);
+}
+
+SourceLocation LineTable::Locate(std::size_t offset) const {
+  Build();
+  if (offset > source_.size()) offset = source_.size();
+
+  // The last line starting at or before the offset
+  auto line = std::upper_bound(line_starts_.begin(), line_starts_.end(),
+                               static_cast<std::uint32_t>(offset)) -
+              1;
+  return SourceLocation{
+      static_cast<std::uint32_t>(line - line_starts_.begin() + 1),
+      static_cast<std::uint32_t>(offset - *line + 1)};
+}
+
+std::size_t LineTable::LineCount() const {
+  Build();
+  return line_starts_.size();
+}
+
+std::string_view LineTable::LineText(std::size_t line) const {
+  Build();
+  if (line == 0 || line > line_starts_.size()) return std::string_view();
+
+  std::size_t start = line_starts_[line - 1];
+  std::size_t end = line < line_starts_.size() ? line_starts_[line] - 1
+                                               : source_.size();
+  return source_.substr(start, end - start);
+}
@@ -0,0 +1,85 @@
+/**
+ * @file line_table.hpp
+ * @brief LineTable class which maps byte offsets of a source text to line and
+ * column numbers. Tokens only carry their byte offset; the table is built
+ * when a location is first asked for (diagnostics, profiling).
+ */
+#ifndef LINE_TABLE_H
+#define LINE_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Line and column of a byte in the source, both starting at 1. The
+ * column counts bytes.
+ */
+struct SourceLocation {
+  std::uint32_t line;
+  std::uint32_t column;
+
+  bool operator==(const SourceLocation &location) const {
+    return line == location.line && column == location.column;
+  }
+
+  /**
+   * @brief Print the location as "line:column"
+   * @param out The output stream to print to
+   * @param location The location to print
+   * @return The output stream with the location printed
+   */
+  friend std::ostream &operator<<(std::ostream &out,
+                                  const SourceLocation &location) {
+    out << location.line << ":" << location.column;
+    return out;
+  }
+};
+
+/**
+ * @brief Offsets of the line starts of a source text, collected with the
+ * SIMD newline scan on the first lookup
+ */
+class LineTable {
+ private:
+  std::string_view source_;
+  // Offset of the first byte of every line, empty until the first lookup
+  mutable std::vector<std::uint32_t> line_starts_;
+
+  /**
+   * @brief Collect the line starts if not done yet
+   */
+  void Build() const;
+
+ public:
+  /**
+   * @brief Construct a LineTable over a source text (nothing is scanned yet)
+   * @pre The source text must outlive the LineTable
+   * @param source the text whose offsets are looked up
+   */
+  explicit LineTable(std::string_view source);
+
+  /**
+   * @brief Get the line and column of a byte
+   * @param offset the byte offset in the source (the source size for the end)
+   * @return SourceLocation the line and column of the byte
+   */
+  SourceLocation Locate(std::size_t offset) const;
+
+  /**
+   * @brief Get the number of lines (a trailing newline starts an empty line)
+   * @return std::size_t the number of lines
+   */
+  std::size_t LineCount() const;
+
+  /**
+   * @brief Get the text of a line, without its newline
+   * @param line the line number, starting at 1
+   * @return std::string_view the text of the line (empty past the last line)
+   */
+  std::string_view LineText(std::size_t line) const;
+};
+
+#endif
@@ -0,0 +1,491 @@
+#include "scan.hpp"
+
+#include "unicode.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SCAN_HAS_X86 1
+#include <immintrin.h>
+#else
+#define SCAN_HAS_X86 0
+#endif
+
+namespace {
+
+// Each byte class provides a scalar test and (on x86) SSE2/AVX2 tests which
+// return 0xFF for every byte lane inside the class. They only accept ASCII,
+// which is what the "C" locale isspace/isalnum/isdigit accept as well.
+
+#if SCAN_HAS_X86
+// Lanes where lo <= byte <= hi (unsigned)
+inline __m128i InRange16(__m128i chunk, char lo, char hi) {
+  __m128i shifted = _mm_sub_epi8(chunk, _mm_set1_epi8(lo));
+  __m128i clamped = _mm_min_epu8(shifted, _mm_set1_epi8(hi - lo));
+  return _mm_cmpeq_epi8(shifted, clamped);
+}
+
+__attribute__((target("avx2"))) inline __m256i InRange32(__m256i chunk,
+                                                         char lo, char hi) {
+  __m256i shifted = _mm256_sub_epi8(chunk, _mm256_set1_epi8(lo));
+  __m256i clamped = _mm256_min_epu8(shifted, _mm256_set1_epi8(hi - lo));
+  return _mm256_cmpeq_epi8(shifted, clamped);
+}
+#endif
+
+struct WhitespaceClass {
+  static bool Scalar(unsigned char ch) {
+    return ch == ' ' || (ch >= '\t' && ch <= '\r');
+  }
+#if SCAN_HAS_X86
+  static __m128i Sse2(__m128i chunk) {
+    return _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')),
+                        InRange16(chunk, '\t', '\r'));
+  }
+  __attribute__((target("avx2"))) static __m256i Avx2(__m256i chunk) {
+    return _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')),
+                           InRange32(chunk, '\t', '\r'));
+  }
+#endif
+};
+
+struct DigitClass {
+  static bool Scalar(unsigned char ch) { return ch >= '0' && ch <= '9'; }
+#if SCAN_HAS_X86
+  static __m128i Sse2(__m128i chunk) { return InRange16(chunk, '0', '9'); }
+  __attribute__((target("avx2"))) static __m256i Avx2(__m256i chunk) {
+    return InRange32(chunk, '0', '9');
+  }
+#endif
+};
+
+struct AlnumClass {
+  static bool Scalar(unsigned char ch) {
+    unsigned char folded = ch | 0x20;
+    return (ch >= '0' && ch <= '9') || (folded >= 'a' && folded <= 'z');
+  }
+#if SCAN_HAS_X86
+  // Setting 0x20 folds upper case letters onto lower case ones
+  static __m128i Sse2(__m128i chunk) {
+    __m128i folded = _mm_or_si128(chunk, _mm_set1_epi8(0x20));
+    return _mm_or_si128(InRange16(chunk, '0', '9'),
+                        InRange16(folded, 'a', 'z'));
+  }
+  __attribute__((target("avx2"))) static __m256i Avx2(__m256i chunk) {
+    __m256i folded = _mm256_or_si256(chunk, _mm256_set1_epi8(0x20));
+    return _mm256_or_si256(InRange32(chunk, '0', '9'),
+                           InRange32(folded, 'a', 'z'));
+  }
+#endif
+};
+
+struct QuoteOrBackslashClass {
+  static bool Scalar(unsigned char ch) { return ch == '"' || ch == '\\'; }
+#if SCAN_HAS_X86
+  static __m128i Sse2(__m128i chunk) {
+    return _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8('"')),
+                        _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\')));
+  }
+  __attribute__((target("avx2"))) static __m256i Avx2(__m256i chunk) {
+    return _mm256_or_si256(_mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('"')),
+                           _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\\')));
+  }
+#endif
+};
+
+struct NewlineClass {
+  static bool Scalar(unsigned char ch) { return ch == '\n'; }
+#if SCAN_HAS_X86
+  static __m128i Sse2(__m128i chunk) {
+    return _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\n'));
+  }
+  __attribute__((target("avx2"))) static __m256i Avx2(__m256i chunk) {
+    return _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\n'));
+  }
+#endif
+};
+
+// kStopInClass: true to stop at the first byte in the class (Find...), false
+// to stop at the first byte outside of the class (Skip...)
+template <typename ByteClass, bool kStopInClass>
+std::size_t ScanScalar(std::string_view text, std::size_t pos) {
+  while (pos < text.size() &&
+         ByteClass::Scalar(static_cast<unsigned char>(text[pos])) !=
+             kStopInClass) {
+    pos++;
+  }
+  return pos;
+}
+
+#if SCAN_HAS_X86
+template <typename ByteClass, bool kStopInClass>
+std::size_t ScanSse2(std::string_view text, std::size_t pos) {
+  const char *data = text.data();
+
+  while (pos + 16 <= text.size()) {
+    __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+    unsigned int mask = _mm_movemask_epi8(ByteClass::Sse2(chunk));
+    if (!kStopInClass) mask = ~mask & 0xFFFFu;
+    if (mask != 0) return pos + __builtin_ctz(mask);
+    pos += 16;
+  }
+
+  return ScanScalar<ByteClass, kStopInClass>(text, pos);
+}
+
+template <typename ByteClass, bool kStopInClass>
+__attribute__((target("avx2"))) std::size_t ScanAvx2(std::string_view text,
+                                                     std::size_t pos) {
+  const char *data = text.data();
+
+  while (pos + 32 <= text.size()) {
+    __m256i chunk =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos));
+    unsigned int mask = static_cast<unsigned int>(
+        _mm256_movemask_epi8(ByteClass::Avx2(chunk)));
+    if (!kStopInClass) mask = ~mask;
+    if (mask != 0) return pos + __builtin_ctz(mask);
+    pos += 32;
+  }
+
+  return ScanSse2<ByteClass, kStopInClass>(text, pos);
+}
+#endif
+
+// Collect...: append the position after every byte in the class
+template <typename ByteClass>
+void CollectScalar(std::string_view text, std::size_t pos,
+                   std::vector<std::uint32_t> *positions) {
+  for (; pos < text.size(); pos++) {
+    if (ByteClass::Scalar(static_cast<unsigned char>(text[pos])))
+      positions->push_back(static_cast<std::uint32_t>(pos + 1));
+  }
+}
+
+#if SCAN_HAS_X86
+template <typename ByteClass>
+void CollectSse2(std::string_view text, std::size_t pos,
+                 std::vector<std::uint32_t> *positions) {
+  const char *data = text.data();
+
+  for (; pos + 16 <= text.size(); pos += 16) {
+    __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+    unsigned int mask = _mm_movemask_epi8(ByteClass::Sse2(chunk));
+    while (mask != 0) {
+      positions->push_back(
+          static_cast<std::uint32_t>(pos + __builtin_ctz(mask) + 1));
+      mask &= mask - 1;
+    }
+  }
+
+  CollectScalar<ByteClass>(text, pos, positions);
+}
+
+template <typename ByteClass>
+__attribute__((target("avx2"))) void CollectAvx2(
+    std::string_view text, std::size_t pos,
+    std::vector<std::uint32_t> *positions) {
+  const char *data = text.data();
+
+  for (; pos + 32 <= text.size(); pos += 32) {
+    __m256i chunk =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos));
+    unsigned int mask = static_cast<unsigned int>(
+        _mm256_movemask_epi8(ByteClass::Avx2(chunk)));
+    while (mask != 0) {
+      positions->push_back(
+          static_cast<std::uint32_t>(pos + __builtin_ctz(mask) + 1));
+      mask &= mask - 1;
+    }
+  }
+
+  CollectSse2<ByteClass>(text, pos, positions);
+}
+#endif
+
+// FindInvalidUtf8...: position of the first invalid UTF-8 sequence, pos must
+// be at the start of a sequence
+std::size_t FindInvalidUtf8Scalar(std::string_view text, std::size_t pos) {
+  while (pos < text.size()) {
+    if (static_cast<unsigned char>(text[pos]) < 0x80) {
+      pos++;
+      continue;
+    }
+    std::uint32_t code_point;
+    std::size_t length = DecodeUtf8(text, pos, &code_point);
+    if (length == 0) return pos;
+    pos += length;
+  }
+  return pos;
+}
+
+#if SCAN_HAS_X86
+// Pure ASCII blocks are skipped 16 bytes at a time, the other characters are
+// decoded one by one
+std::size_t FindInvalidUtf8Sse2(std::string_view text, std::size_t pos) {
+  const char *data = text.data();
+
+  while (pos + 16 <= text.size()) {
+    __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + pos));
+    unsigned int mask = _mm_movemask_epi8(chunk);
+    if (mask == 0) {
+      pos += 16;
+      continue;
+    }
+
+    pos += __builtin_ctz(mask);
+    std::uint32_t code_point;
+    std::size_t length = DecodeUtf8(text, pos, &code_point);
+    if (length == 0) return pos;
+    pos += length;
+  }
+
+  return FindInvalidUtf8Scalar(text, pos);
+}
+
+// Error bits of the two byte patterns checked by ClassifyUtf8Pairs (Keiser
+// and Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte")
+constexpr std::uint8_t kTooShort = 1 << 0;  // 11______ 0_______/11______
+constexpr std::uint8_t kTooLong = 1 << 1;  // 0_______ 10______
+constexpr std::uint8_t kOverlong3 = 1 << 2;  // 11100000 100_____
+constexpr std::uint8_t kTooLarge = 1 << 3;  // 11110100 1001____ and up
+constexpr std::uint8_t kSurrogate = 1 << 4;  // 11101101 101_____
+constexpr std::uint8_t kOverlong2 = 1 << 5;  // 1100000_ 10______
+constexpr std::uint8_t kTooLarge1000 = 1 << 6;  // 11110101+ 1000____
+constexpr std::uint8_t kOverlong4 = 1 << 6;  // 11110000 1000____
+constexpr std::uint8_t kTwoConts = 1 << 7;  // 10______ 10______
+constexpr std::uint8_t kCarry = kTooShort | kTooLong | kTwoConts;
+
+__attribute__((target("avx2"))) inline __m256i Lookup16(
+    __m256i nibbles, const std::uint8_t (&table)[16]) {
+  __m128i lane = _mm_loadu_si128(reinterpret_cast<const __m128i *>(table));
+  return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(lane), nibbles);
+}
+
+__attribute__((target("avx2"))) inline __m256i HighNibbles(__m256i chunk) {
+  return _mm256_and_si256(_mm256_srli_epi16(chunk, 4), _mm256_set1_epi8(0x0F));
+}
+
+// The chunk shifted by kCount bytes, the first bytes taken from previous
+template <int kCount>
+__attribute__((target("avx2"))) inline __m256i PreviousBytes(
+    __m256i chunk, __m256i previous) {
+  return _mm256_alignr_epi8(
+      chunk, _mm256_permute2x128_si256(previous, chunk, 0x21), 16 - kCount);
+}
+
+// Error bits of every (byte, next byte) pair, except for the missing or
+// extra continuation bytes of 3 and 4 byte sequences
+__attribute__((target("avx2"))) inline __m256i ClassifyUtf8Pairs(
+    __m256i chunk, __m256i prev1) {
+  static constexpr std::uint8_t kByte1High[16] = {
+      kTooLong, kTooLong, kTooLong, kTooLong,
+      kTooLong, kTooLong, kTooLong, kTooLong,
+      kTwoConts, kTwoConts, kTwoConts, kTwoConts,
+      kTooShort | kOverlong2,
+      kTooShort,
+      kTooShort | kOverlong3 | kSurrogate,
+      kTooShort | kTooLarge | kTooLarge1000 | kOverlong4,
+  };
+  static constexpr std::uint8_t kByte1Low[16] = {
+      kCarry | kOverlong3 | kOverlong2 | kOverlong4,
+      kCarry | kOverlong2,
+      kCarry,
+      kCarry,
+      kCarry | kTooLarge,
+      kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000 | kSurrogate,
+      kCarry | kTooLarge | kTooLarge1000,
+      kCarry | kTooLarge | kTooLarge1000,
+  };
+  static constexpr std::uint8_t kByte2High[16] = {
+      kTooShort, kTooShort, kTooShort, kTooShort,
+      kTooShort, kTooShort, kTooShort, kTooShort,
+      kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge1000 |
+          kOverlong4,
+      kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge,
+      kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+      kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+      kTooShort, kTooShort, kTooShort, kTooShort,
+  };
+
+  __m256i byte1_high = Lookup16(HighNibbles(prev1), kByte1High);
+  __m256i byte1_low =
+      Lookup16(_mm256_and_si256(prev1, _mm256_set1_epi8(0x0F)), kByte1Low);
+  __m256i byte2_high = Lookup16(HighNibbles(chunk), kByte2High);
+  return _mm256_and_si256(_mm256_and_si256(byte1_high, byte1_low),
+                          byte2_high);
+}
+
+// Non zero lanes where the chunk has a UTF-8 error
+__attribute__((target("avx2"))) inline __m256i CheckUtf8Chunk(
+    __m256i chunk, __m256i previous) {
+  __m256i pairs = ClassifyUtf8Pairs(chunk, PreviousBytes<1>(chunk, previous));
+
+  // The 2nd byte after a 3 or 4 byte lead and the 3rd byte after a 4 byte
+  // lead must be continuation bytes (0x80 after saturation), which the pair
+  // classification left as kTwoConts
+  __m256i third =
+      _mm256_subs_epu8(PreviousBytes<2>(chunk, previous),
+                       _mm256_set1_epi8(static_cast<char>(0xE0 - 0x80)));
+  __m256i fourth =
+      _mm256_subs_epu8(PreviousBytes<3>(chunk, previous),
+                       _mm256_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+  __m256i must_continue =
+      _mm256_and_si256(_mm256_or_si256(third, fourth),
+                       _mm256_set1_epi8(static_cast<char>(0x80)));
+  return _mm256_xor_si256(must_continue, pairs);
+}
+
+// Non zero lanes if the chunk ends inside a sequence
+__attribute__((target("avx2"))) inline __m256i Utf8Incomplete(__m256i chunk) {
+  const __m256i kMaxComplete = _mm256_setr_epi8(
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, static_cast<char>(0xF0 - 1),
+      static_cast<char>(0xE0 - 1), static_cast<char>(0xC0 - 1));
+  return _mm256_subs_epu8(chunk, kMaxComplete);
+}
+
+// Validates 32 byte blocks with the lookup algorithm. A block with an error
+// (and the tail) is handed to the SSE2 kernel, which finds its position.
+__attribute__((target("avx2"))) std::size_t FindInvalidUtf8Avx2(
+    std::string_view text, std::size_t pos) {
+  const char *data = text.data();
+  std::size_t start = pos;
+  __m256i previous = _mm256_setzero_si256();
+  __m256i incomplete = _mm256_setzero_si256();
+
+  while (pos + 32 <= text.size()) {
+    __m256i chunk =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + pos));
+    // In a pure ASCII block only a sequence cut by the previous block is an
+    // error
+    bool ascii = _mm256_movemask_epi8(chunk) == 0;
+    __m256i error = ascii ? incomplete : CheckUtf8Chunk(chunk, previous);
+    if (!_mm256_testz_si256(error, error)) break;
+    incomplete = ascii ? _mm256_setzero_si256() : Utf8Incomplete(chunk);
+    previous = chunk;
+    pos += 32;
+  }
+
+  // Every sequence starting 4 bytes or more before pos is valid, restart at
+  // the first sequence after them
+  std::size_t restart = pos - start > 3 ? pos - 3 : start;
+  while (restart < pos &&
+         (static_cast<unsigned char>(data[restart]) & 0xC0) == 0x80) {
+    restart++;
+  }
+  return FindInvalidUtf8Sse2(text, restart);
+}
+#endif
+
+typedef std::size_t (*ScanFunction)(std::string_view, std::size_t);
+typedef void (*CollectFunction)(std::string_view, std::size_t,
+                                std::vector<std::uint32_t> *);
+
+/**
+ * @brief The kernels of one instruction set
+ */
+struct ScanTable {
+  ScanKernel kernel;
+  ScanFunction whitespace;
+  ScanFunction identifier;
+  ScanFunction digits;
+  ScanFunction quote_or_backslash;
+  CollectFunction newlines;
+  ScanFunction invalid_utf8;
+};
+
+// The table of an instruction set, which must be supported by the CPU
+ScanTable KernelTable(ScanKernel kernel) {
+#if SCAN_HAS_X86
+  if (kernel == ScanKernel::AVX2) {
+    return ScanTable{ScanKernel::AVX2, ScanAvx2<WhitespaceClass, false>,
+                     ScanAvx2<AlnumClass, false>, ScanAvx2<DigitClass, false>,
+                     ScanAvx2<QuoteOrBackslashClass, true>,
+                     CollectAvx2<NewlineClass>, FindInvalidUtf8Avx2};
+  }
+  if (kernel == ScanKernel::SSE2) {
+    return ScanTable{ScanKernel::SSE2, ScanSse2<WhitespaceClass, false>,
+                     ScanSse2<AlnumClass, false>, ScanSse2<DigitClass, false>,
+                     ScanSse2<QuoteOrBackslashClass, true>,
+                     CollectSse2<NewlineClass>, FindInvalidUtf8Sse2};
+  }
+#endif
+  return ScanTable{ScanKernel::SCALAR, ScanScalar<WhitespaceClass, false>,
+                   ScanScalar<AlnumClass, false>, ScanScalar<DigitClass, false>,
+                   ScanScalar<QuoteOrBackslashClass, true>,
+                   CollectScalar<NewlineClass>, FindInvalidUtf8Scalar};
+}
+
+bool KernelSupported(ScanKernel kernel) {
+  switch (kernel) {
+    case ScanKernel::SCALAR:
+      return true;
+#if SCAN_HAS_X86
+    case ScanKernel::SSE2:
+      return true;
+    case ScanKernel::AVX2:
+      __builtin_cpu_init();
+      return __builtin_cpu_supports("avx2");
+#endif
+    default:
+      return false;
+  }
+}
+
+// The fastest instruction set of the CPU
+ScanKernel BestKernel() {
+  if (KernelSupported(ScanKernel::AVX2)) return ScanKernel::AVX2;
+  if (KernelSupported(ScanKernel::SSE2)) return ScanKernel::SSE2;
+  return ScanKernel::SCALAR;
+}
+
+// Picked on first use, SetScanKernel() replaces it
+ScanTable &ActiveScanTable() {
+  static ScanTable table = KernelTable(BestKernel());
+  return table;
+}
+
+}  // namespace
+
+ScanKernel ActiveScanKernel() { return ActiveScanTable().kernel; }
+
+bool SetScanKernel(ScanKernel kernel) {
+  if (!KernelSupported(kernel)) return false;
+  ActiveScanTable() = KernelTable(kernel);
+  return true;
+}
+
+std::size_t SkipWhitespace(std::string_view text, std::size_t pos) {
+  return ActiveScanTable().whitespace(text, pos);
+}
+
+std::size_t SkipIdentifier(std::string_view text, std::size_t pos) {
+  return ActiveScanTable().identifier(text, pos);
+}
+
+std::size_t SkipDigits(std::string_view text, std::size_t pos) {
+  return ActiveScanTable().digits(text, pos);
+}
+
+std::size_t FindQuoteOrBackslash(std::string_view text, std::size_t pos) {
+  return ActiveScanTable().quote_or_backslash(text, pos);
+}
+
+void CollectLineStarts(std::string_view text,
+                       std::vector<std::uint32_t> *line_starts) {
+  ActiveScanTable().newlines(text, 0, line_starts);
+}
+
+std::size_t FindInvalidUtf8(std::string_view text, std::size_t pos) {
+  return ActiveScanTable().invalid_utf8(text, pos);
+}
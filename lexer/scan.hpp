@@ -0,0 +1,91 @@
+/**
+ * @file scan.hpp
+ * @brief Character class scanning kernels used by the Lexer to find the end of
+ * a run of bytes in one call (SSE2/AVX2 on x86, scalar elsewhere)
+ */
+#ifndef SCAN_H
+#define SCAN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Instruction set used by the scanning kernels, chosen once at runtime
+ */
+enum class ScanKernel { SCALAR, SSE2, AVX2 };
+
+/**
+ * @brief Get the instruction set selected for the scanning kernels (CPUID)
+ * @return ScanKernel the kernel used by the Skip... and Find... functions
+ */
+ScanKernel ActiveScanKernel();
+
+/**
+ * @brief Force the instruction set of the scanning kernels, so each one can be
+ * tested or benchmarked on a CPU which has a faster one
+ * @pre No text is being scanned (the kernels are switched for every thread)
+ * @param kernel the instruction set to use
+ * @return bool false (and nothing changes) if the CPU does not support it
+ */
+bool SetScanKernel(ScanKernel kernel);
+
+/**
+ * @brief Skip a run of whitespace (' ', '\\t', '\\n', '\\v', '\\f', '\\r')
+ * @param text the text to scan
+ * @param pos the position to start scanning from
+ * @return std::size_t the position of the first non whitespace byte (or
+ * text.size())
+ */
+std::size_t SkipWhitespace(std::string_view text, std::size_t pos);
+
+/**
+ * @brief Skip a run of ASCII letters and digits (identifier body)
+ * @param text the text to scan
+ * @param pos the position to start scanning from
+ * @return std::size_t the position of the first non alphanumeric byte (or
+ * text.size())
+ */
+std::size_t SkipIdentifier(std::string_view text, std::size_t pos);
+
+/**
+ * @brief Skip a run of ASCII digits
+ * @param text the text to scan
+ * @param pos the position to start scanning from
+ * @return std::size_t the position of the first non digit byte (or
+ * text.size())
+ */
+std::size_t SkipDigits(std::string_view text, std::size_t pos);
+
+/**
+ * @brief Find the next double quote or backslash (string literal body)
+ * @param text the text to scan
+ * @param pos the position to start scanning from
+ * @return std::size_t the position of the next '"' or '\\' (or text.size())
+ */
+std::size_t FindQuoteOrBackslash(std::string_view text, std::size_t pos);
+
+/**
+ * @brief Find the first invalid UTF-8 sequence (bad lead or continuation
+ * byte, overlong encoding, surrogate, code point past U+10FFFF or a sequence
+ * cut by the end of the text). Pure ASCII blocks are skipped without
+ * decoding.
+ * @param text the text to validate
+ * @param pos the position to start validating from, at the start of a
+ * sequence
+ * @return std::size_t the position of the first byte of the first invalid
+ * sequence (or text.size() if the text is valid)
+ */
+std::size_t FindInvalidUtf8(std::string_view text, std::size_t pos);
+
+/**
+ * @brief Append the offset of the byte following every '\\n' in the text
+ * (the start of each line after the first)
+ * @param text the text to scan (at most 4 GiB)
+ * @param line_starts receives the offsets, in increasing order
+ */
+void CollectLineStarts(std::string_view text,
+                       std::vector<std::uint32_t> *line_starts);
+
+#endif
@@ -0,0 +1,106 @@
+#include "stream_lexer.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+
+#include "file.hpp"
+
+StreamLexer::StreamLexer(int fd, std::size_t chunk_size)
+    : fd_(fd),
+      owns_fd_(false),
+      eof_(false),
+      chunk_size_(chunk_size == 0 ? kDefaultChunkSize : chunk_size),
+      window_offset_(0),
+      window_location_{1, 1},
+      operators_(&OperatorRegistry::Builtin()),
+      lexer_(window_.data(), 0) {}
+
+StreamLexer::StreamLexer(const std::string &filename, std::size_t chunk_size)
+    : StreamLexer(open(filename.c_str(), O_RDONLY | O_CLOEXEC), chunk_size) {
+  if (fd_ < 0) throw FileNotOpenedException();
+  owns_fd_ = true;
+}
+
+StreamLexer::~StreamLexer() {
+  if (owns_fd_ && fd_ >= 0) close(fd_);
+}
+
+void StreamLexer::Refill(std::size_t keep_from) {
+  if (fd_ < 0) throw FileNotOpenedException();
+
+  // Move the location of the window start over the dropped bytes
+  std::string_view dropped = std::string_view(window_).substr(0, keep_from);
+  std::size_t last_newline = dropped.rfind('\n');
+  if (last_newline == std::string_view::npos) {
+    window_location_.column += static_cast<std::uint32_t>(keep_from);
+  } else {
+    window_location_.line += static_cast<std::uint32_t>(
+        std::count(dropped.begin(), dropped.end(), '\n'));
+    window_location_.column =
+        static_cast<std::uint32_t>(keep_from - last_newline);
+  }
+
+  window_.erase(0, keep_from);
+  window_offset_ += keep_from;
+
+  // A token longer than a chunk grows the read size geometrically, so it is
+  // rescanned a logarithmic rather than linear number of times
+  std::size_t kept = window_.size();
+  std::size_t request_size = kept > chunk_size_ ? kept : chunk_size_;
+  window_.resize(kept + request_size);
+
+  ssize_t read_size;
+  do {
+    read_size = read(fd_, window_.data() + kept, request_size);
+  } while (read_size < 0 && errno == EINTR);
+
+  if (read_size < 0) {
+    std::stringstream ss_read_err_msg;
+    ss_read_err_msg << "Failed to read the script: " << std::strerror(errno);
+    throw StreamReadException(ss_read_err_msg.str());
+  }
+
+  window_.resize(kept + read_size);
+  if (read_size == 0) eof_ = true;
+
+  // The window may have moved, lex it from its beginning
+  lexer_ = Lexer(window_.data(), window_.size());
+  lexer_.SetOperators(*operators_);
+  lexer_.SetBaseLocation(window_location_);
+}
+
+void StreamLexer::SetOperators(const OperatorRegistry &operators) {
+  operators_ = &operators;
+  lexer_.SetOperators(operators);
+}
+
+TokenPtr StreamLexer::NextToken() {
+  while (true) {
+    std::size_t start = lexer_.Position();
+
+    try {
+      Lexeme lexeme = lexer_.Scan();
+
+      // A token ending too close to the end of the window (or the end of the
+      // window itself) may continue in the next chunk, so read more and lex it
+      // again. The first call lands here too, since the window starts out
+      // empty.
+      if (!eof_ && lexer_.Position() + lexer_.Lookahead() > window_.size()) {
+        Refill(start);
+        continue;
+      }
+
+      return lexer_.ToToken(lexeme, window_offset_);
+    } catch (WrongLexingException &) {
+      // Only an error at the end of the window (an unterminated string) can
+      // be caused by the chunk boundary
+      if (eof_ || lexer_.Position() < window_.size()) throw;
+      Refill(start);
+    }
+  }
+}
@@ -0,0 +1,107 @@
+/**
+ * @file stream_lexer.hpp
+ * @brief StreamLexer class which lexes a script while reading it in fixed size
+ * chunks, so memory use is bounded by the chunk size instead of the script
+ * size
+ */
+#ifndef STREAM_LEXER_H
+#define STREAM_LEXER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "lexer.hpp"
+#include "line_table.hpp"
+#include "operator_registry.hpp"
+#include "token.hpp"
+
+/**
+ * @brief Lexer over a file descriptor. Only a window of the script is kept in
+ * memory: the bytes of the token being lexed plus one chunk read ahead.
+ */
+class StreamLexer {
+ private:
+  int fd_;
+  bool owns_fd_;
+  bool eof_;
+  std::size_t chunk_size_;
+
+  // Unconsumed bytes of the script, window_[0] is at stream offset
+  // window_offset_
+  std::string window_;
+  std::uint64_t window_offset_;
+  // Line and column of window_[0], for the locations in error messages
+  SourceLocation window_location_;
+  // The operators the lexer matches, kept when the lexer is rebuilt
+  const OperatorRegistry *operators_;
+  Lexer lexer_;
+
+  /**
+   * @brief Drop the bytes before the cursor and read the next chunk
+   * @param keep_from the window position of the first byte to keep
+   */
+  void Refill(std::size_t keep_from);
+
+ public:
+  /**
+   * @brief Default number of bytes read from the file descriptor at once
+   */
+  static constexpr std::size_t kDefaultChunkSize = 64 * 1024;
+
+  /**
+   * @brief Construct a new StreamLexer reading from an open file descriptor
+   * (the descriptor is not closed by the StreamLexer)
+   * @param fd the file descriptor to read the script from (file, pipe, ...)
+   * @param chunk_size the number of bytes to read at once
+   */
+  StreamLexer(int fd, std::size_t chunk_size = kDefaultChunkSize);
+
+  /**
+   * @brief Construct a new StreamLexer reading the script file
+   * @param filename the name of the script file
+   * @param chunk_size the number of bytes to read at once
+   */
+  StreamLexer(const std::string &filename,
+              std::size_t chunk_size = kDefaultChunkSize);
+  ~StreamLexer();
+
+  StreamLexer(const StreamLexer &) = delete;
+  StreamLexer &operator=(const StreamLexer &) = delete;
+
+  /**
+   * @brief Choose the operators the lexer matches (by default
+   * OperatorRegistry::Builtin())
+   * @pre The registry must outlive the StreamLexer
+   * @param operators the registry of the operators
+   */
+  void SetOperators(const OperatorRegistry &operators);
+
+  /**
+   * @brief Get the next token, reading more of the script when the token may
+   * continue past the bytes read so far
+   * @return TokenPtr the next token (TokenType::EOL at the end of the script)
+   */
+  TokenPtr NextToken();
+
+  /**
+   * @brief Get the stream offset of the next token
+   * @return std::uint64_t the byte offset from the beginning of the script
+   */
+  std::uint64_t Offset() const { return window_offset_ + lexer_.Position(); }
+};
+
+/**
+ * @brief Exceptions if reading the script from the file descriptor failed
+ */
+class StreamReadException : public std::exception {
+ private:
+  std::string err_info_;
+
+ public:
+  StreamReadException(std::string err_info) : err_info_(err_info){};
+
+  const char *what() const noexcept override { return err_info_.c_str(); }
+};
+
+#endif
@@ -0,0 +1,62 @@
+/**
+ * @file unicode.hpp
+ * @brief UTF-8 decoding and encoding and the Unicode identifier properties
+ * (XID_Start, XID_Continue) used by the Lexer for non ASCII identifiers
+ */
+#ifndef UNICODE_H
+#define UNICODE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Get the length of the UTF-8 sequence started by a byte
+ * @param lead the first byte of the sequence
+ * @return std::size_t 1 to 4, 0 if the byte can't start a sequence (a
+ * continuation byte, 0xC0, 0xC1 or 0xF5 and above)
+ */
+constexpr std::size_t Utf8SequenceLength(unsigned char lead) {
+  if (lead < 0x80) return 1;
+  if (lead < 0xC2) return 0;
+  if (lead < 0xE0) return 2;
+  if (lead < 0xF0) return 3;
+  if (lead < 0xF5) return 4;
+  return 0;
+}
+
+/**
+ * @brief Decode the UTF-8 sequence at a position, rejecting overlong
+ * encodings, surrogates and code points past U+10FFFF
+ * @param text the UTF-8 text
+ * @param pos the position of the first byte of the sequence
+ * @param code_point receives the decoded code point
+ * @return std::size_t the length of the sequence, 0 if it is invalid or cut
+ * by the end of the text
+ */
+std::size_t DecodeUtf8(std::string_view text, std::size_t pos,
+                       std::uint32_t *code_point);
+
+/**
+ * @brief Append the UTF-8 encoding of a code point
+ * @param code_point the code point (at most U+10FFFF, not a surrogate)
+ * @param out the string to append to
+ */
+void AppendUtf8(std::uint32_t code_point, std::string *out);
+
+/**
+ * @brief Check if a code point may start an identifier (XID_Start)
+ * @param code_point the code point
+ * @return bool true if the code point has the XID_Start property
+ */
+bool IsXidStart(std::uint32_t code_point);
+
+/**
+ * @brief Check if a code point may continue an identifier (XID_Continue)
+ * @param code_point the code point
+ * @return bool true if the code point has the XID_Continue property
+ */
+bool IsXidContinue(std::uint32_t code_point);
+
+#endif
@@ -1,19 +1,18 @@
 #include <iostream>
-#include <queue>
 #include <string>
 
 #include "lexer.hpp"
 #include "parser.hpp"
 #include "runtime.hpp"
 #include "token.hpp"
+#include "token_buffer.hpp"
 
-// Set limit of printing token from one lexer
+// Print the tokens of every input (up to the limit) for debugging
 #define DEBUG_SET_PRINT_LIMIT false
 #define PREVENT_LOOP_MAX_COUNT 10
 
 int main() {
   std::string input;
-  std::queue<TokenPtr> tokqueue;
   Parser parser = Parser();
 
   Evaluater evaluater = Evaluater();
@@ -23,38 +22,28 @@ int main() {
     std::getline(std::cin, input);
     if (input == "exit") return 0;
 
-    Lexer lexer = Lexer(input);
-    TokenPtr tok;
+    // The input line outlives the lexer, so lex it in place without copying
+    Lexer lexer = Lexer(input.data(), input.size());
+    // The parser ignores whitespace, leave it out of the tokens
+    lexer.SetKeepWhitespace(false);
 
 #if DEBUG_SET_PRINT_LIMIT
-    int countLoop = 0;
-#endif
-
-    do {
-      tok = lexer.NextToken();
-      tokqueue.push(tok);
-
-#if DEBUG_SET_PRINT_LIMIT
-      if (countLoop > PREVENT_LOOP_MAX_COUNT) break;
-      countLoop++;
-#endif
-    } while (tok->Type() != TokenType::EOL);
-
-    // If null input, continue
-    if (tokqueue.front()->Type() == TokenType::EOL) {
-      tokqueue.pop();
-      continue;
+    Lexer debug_lexer = Lexer(input.data(), input.size());
+    TokenBuffer tokens = debug_lexer.Tokenize();
+    for (std::size_t i = 0; i < tokens.Size() && i <= PREVENT_LOOP_MAX_COUNT;
+         i++) {
+      std::cout << *(tokens.ToToken(i)) << std::endl;
     }
+#endif
 
-    tokqueue.push(GenerateToken("", TokenType::EOL, OperatorPtr(nullptr)));
+    // Parse the tokens as the parser pulls them from the lexer and produce
+    // Abstract Syntax Tree (AST)
+    Program program = parser.ProduceAST(lexer);
 
-    // Parse the token and produce Abstract Syntax Tree (AST)
-    Program program = parser.ProduceAST(tokqueue);
+    // If null (or blank) input, continue
+    if (program.body_.empty()) continue;
 
     // Evaluate the AST and produce the result in string
     std::cout << evaluater.EvaluateProgram(program) << std::endl;
-
-    // Reset the token queue
-    tokqueue = std::queue<TokenPtr>();
   } while (true);
 }
@@ -2,6 +2,8 @@
 
 #include <sstream>
 
+#include "operator_registry.hpp"
+
 Operator::Operator(std::string input) {
   value_ = input;
 
@@ -16,6 +18,13 @@ Operator::Operator(std::string input, OperatorType op_type) {
   FillOperatorMembers();
 }
 
+Operator::Operator(const OperatorInfo &info)
+    : op_type_(info.op_type),
+      value_(info.text),
+      overloadable_(info.overloadable),
+      precedence_(info.precedence),
+      right_associative_(info.associativity == Associativity::RIGHT) {}
+
 Operator::~Operator(){};
 
 OperatorType Operator::Type() const { return op_type_; }
@@ -26,70 +35,69 @@ bool Operator::IsOverloadable() const { return overloadable_; }
 
 int Operator::Precedence() const { return precedence_; }
 
+bool Operator::IsRightAssociative() const { return right_associative_; }
+
 void Operator::FillOperatorMembers() {
-  switch (op_type_) {
-    case OperatorType::STAR:
-    case OperatorType::SLASH:
-      precedence_ = 6;
-      overloadable_ = false;
-      break;
-    case OperatorType::PLUS:
-    case OperatorType::MINUS:
-      precedence_ = 5;
-      overloadable_ = false;
-      break;
-    case OperatorType::NOT:
-      precedence_ = 5;
-      overloadable_ = true;
-      break;
-    case OperatorType::L_PARENTHESIS:
-    case OperatorType::R_PARENTHESIS:
-      precedence_ = 4;
-      overloadable_ = false;
-      break;
-    case OperatorType::L_BRACE:
-    case OperatorType::R_BRACE:
-      precedence_ = 3;
-      overloadable_ = false;
-      break;
-    case OperatorType::ASSIGN:
-      precedence_ = 2;
-      overloadable_ = true;
-      break;
-    case OperatorType::EQUAL:
-    case OperatorType::NOT_EQUAL:
-      precedence_ = 1;
-      overloadable_ = false;
-      break;
-    default:
-      precedence_ = 7;
-      overloadable_ = false;
+  const OperatorInfo *info = OperatorRegistry::Builtin().Find(op_type_);
+  if (info == nullptr) {
+    precedence_ = 7;
+    overloadable_ = false;
+    right_associative_ = false;
+    return;
   }
+
+  precedence_ = info->precedence;
+  overloadable_ = info->overloadable;
+  right_associative_ = info->associativity == Associativity::RIGHT;
 }
 
 OperatorType Operator::GetOperatorType(std::string input) {
-  if (input == "+") return OperatorType::PLUS;
-  if (input == "-") return OperatorType::MINUS;
-  if (input == "*") return OperatorType::STAR;
-  if (input == "/") return OperatorType::SLASH;
-  if (input == "(") return OperatorType::L_PARENTHESIS;
-  if (input == ")") return OperatorType::R_PARENTHESIS;
-  if (input == "{") return OperatorType::L_BRACE;
-  if (input == "}") return OperatorType::R_BRACE;
-  if (input == "=") return OperatorType::ASSIGN;
-  if (input == "==") return OperatorType::EQUAL;
-  if (input == "!") return OperatorType::NOT;
-  if (input == "!=") return OperatorType::NOT_EQUAL;
+  const OperatorInfo *info = OperatorRegistry::Builtin().Find(input);
+  if (info != nullptr) return info->op_type;
 
   std::stringstream ss_invalid_op_msg;
   ss_invalid_op_msg << "Operator: \'" << input << "\' is not allowed";
   throw InvalidOperatorTypeException(ss_invalid_op_msg.str());
 }
 
+OperatorPtr GenerateOp(OperatorType op_type) {
+  // One Operator per built-in operator, shared by every token of that
+  // operator and indexed by OperatorType
+  constexpr std::size_t kBuiltinTypes =
+      static_cast<std::size_t>(OperatorType::USER_DEFINED);
+  static const std::array<OperatorPtr, kBuiltinTypes> shared_ops = [] {
+    std::array<OperatorPtr, kBuiltinTypes> ops;
+    for (const OperatorInfo &info : kOperatorTable)
+      ops[static_cast<std::size_t>(info.op_type)] =
+          std::make_shared<Operator>(info);
+    return ops;
+  }();
+
+  std::size_t index = static_cast<std::size_t>(op_type);
+  if (index >= kBuiltinTypes || shared_ops[index] == nullptr) {
+    std::stringstream ss_invalid_op_msg;
+    ss_invalid_op_msg << "OperatorType: \'" << static_cast<int>(op_type)
+                      << "\' is not allowed";
+    throw InvalidOperatorTypeException(ss_invalid_op_msg.str());
+  }
+
+  return shared_ops[index];
+}
+
 OperatorPtr GenerateOp(const std::string &input) {
-  return OperatorPtr(new Operator(input));
+  return GenerateOp(Operator::GetOperatorType(input));
 }
 
 OperatorPtr GenerateOp(const std::string &input, OperatorType op_type) {
+  const OperatorInfo *info = OperatorRegistry::Builtin().Find(op_type);
+  if (info != nullptr && info->text == input) return GenerateOp(op_type);
+
   return OperatorPtr(new Operator(input, op_type));
-}
\ No newline at end of file
+}
+
+OperatorPtr GenerateOp(const OperatorInfo &info) {
+  if (info.op_type < OperatorType::USER_DEFINED)
+    return GenerateOp(info.op_type);
+
+  return std::make_shared<Operator>(info);
+}
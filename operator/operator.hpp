@@ -5,14 +5,17 @@
 #ifndef OPERATOR_H
 #define OPERATOR_H
 
+#include <array>
+#include <cstdint>
 #include <iostream>
 #include <memory>
 #include <string>
+#include <string_view>
 
 /**
  * @brief Enum class to represent the type of operator
  */
-enum class OperatorType {
+enum class OperatorType : std::uint8_t {
   // General
   ASSIGN,
   INVALID,
@@ -33,8 +36,54 @@ enum class OperatorType {
   // Comparison
   EQUAL,
   NOT_EQUAL,
+
+  // The values from USER_DEFINED on are handed out to the infix operators
+  // registered at runtime (OperatorRegistry::RegisterInfix)
+  USER_DEFINED = 64,
 };
 
+/**
+ * @brief How a chain of infix operators of the same precedence groups,
+ * "a - b - c" is "(a - b) - c" (LEFT)
+ */
+enum class Associativity : std::uint8_t { LEFT, RIGHT };
+
+/**
+ * @brief Static description of an operator: its spelling, type, precedence,
+ * whether a longer operator starts with it, and whether (and how) the parser
+ * treats it as a binary infix operator
+ */
+struct OperatorInfo {
+  std::string_view text;
+  OperatorType op_type;
+  int precedence;
+  bool overloadable;
+  bool infix;
+  Associativity associativity;
+};
+
+/**
+ * @brief Every built-in operator of the language. The OperatorRegistry (and
+ * so the lexer and parser) and the Operator class fill their members from
+ * this table. Infix operators with a higher precedence bind tighter, the
+ * precedence of a prefix operator is the lowest one its operand takes.
+ */
+inline constexpr std::array<OperatorInfo, 12> kOperatorTable = {{
+    {"*", OperatorType::STAR, 6, false, true, Associativity::LEFT},
+    {"/", OperatorType::SLASH, 6, false, true, Associativity::LEFT},
+    {"+", OperatorType::PLUS, 5, false, true, Associativity::LEFT},
+    {"-", OperatorType::MINUS, 5, false, true, Associativity::LEFT},
+    {"(", OperatorType::L_PARENTHESIS, 4, false, false, Associativity::LEFT},
+    {")", OperatorType::R_PARENTHESIS, 4, false, false, Associativity::LEFT},
+    {"{", OperatorType::L_BRACE, 3, false, false, Associativity::LEFT},
+    {"}", OperatorType::R_BRACE, 3, false, false, Associativity::LEFT},
+    {"==", OperatorType::EQUAL, 2, false, true, Associativity::LEFT},
+    {"!=", OperatorType::NOT_EQUAL, 2, false, true, Associativity::LEFT},
+    // The left operand of an assignment must be an identifier
+    {"=", OperatorType::ASSIGN, 1, true, true, Associativity::RIGHT},
+    // Prefix, its operand is a whole expression (assignments included)
+    {"!", OperatorType::NOT, 1, true, false, Associativity::LEFT},
+}};
 /**
  * @brief Operator class to represent an operator in the language
  */
@@ -44,6 +93,7 @@ class Operator {
   std::string value_;
   bool overloadable_;
   int precedence_;
+  bool right_associative_;
 
   // Fill out overloadable, and precedence parameter members based on
   // OperatorType member
@@ -65,6 +115,12 @@ class Operator {
     * @param op_type The operator type (OperatorType) of the Operator
     */
   Operator(std::string input, OperatorType op_type);
+  /**
+   * @brief Constructor for Operator class from its registry entry (built-in or
+   * registered at runtime)
+   * @param info The description of the operator
+   */
+  explicit Operator(const OperatorInfo &info);
 
   ~Operator();
 
@@ -95,6 +151,12 @@ class Operator {
    * @return int The precedence of the Operator object
    */
   int Precedence() const;
+  /**
+   * @brief Check if a chain of the operator groups from the right
+   * ("a = b = c" is "a = (b = c)")
+   * @return bool True if the operator is right associative
+   */
+  bool IsRightAssociative() const;
 
   /**
    * @brief Check if the Operator object is equal to another Operator object
@@ -131,6 +193,13 @@ class InvalidOperatorTypeException : public std::exception {
 
 typedef std::shared_ptr<Operator> OperatorPtr;
 
+/**
+ * @brief Get the shared, immutable Operator object of an operator in
+ * kOperatorTable (no allocation)
+ * @param op_type The OperatorType of the Operator
+ * @return OperatorPtr The shared Operator object
+ */
+OperatorPtr GenerateOp(OperatorType op_type);
 /**
  * @brief Generate an Operator object from a string input
  * @param input The string input of the Operator
@@ -144,5 +213,12 @@ OperatorPtr GenerateOp(const std::string &input);
  * @return OperatorPtr The Operator object generated from the input
  */
 OperatorPtr GenerateOp(const std::string &input, OperatorType op_type);
+/**
+ * @brief Generate an Operator object from its registry entry (shared for the
+ * built-in operators)
+ * @param info The description of the operator (see OperatorRegistry)
+ * @return OperatorPtr The Operator object of the operator
+ */
+OperatorPtr GenerateOp(const OperatorInfo &info);
 
 #endif
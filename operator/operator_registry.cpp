@@ -0,0 +1,111 @@
+#include "operator_registry.hpp"
+
+#include <sstream>
+
+OperatorRegistry::OperatorRegistry()
+    : nodes_(1),
+      max_length_(0),
+      next_user_type_(static_cast<int>(OperatorType::USER_DEFINED)) {
+  by_type_.fill(-1);
+  for (const OperatorInfo &info : kOperatorTable) Insert(info);
+}
+
+const OperatorRegistry &OperatorRegistry::Builtin() {
+  static const OperatorRegistry builtin;
+  return builtin;
+}
+
+void OperatorRegistry::Insert(const OperatorInfo &info) {
+  std::size_t node = 0;
+  for (char ch : info.text) {
+    unsigned char byte = static_cast<unsigned char>(ch);
+    if (nodes_[node].children[byte] == 0) {
+      nodes_[node].children[byte] = static_cast<std::uint16_t>(nodes_.size());
+      nodes_.emplace_back();
+    }
+    node = nodes_[node].children[byte];
+  }
+
+  std::int16_t index = static_cast<std::int16_t>(infos_.size());
+  infos_.push_back(info);
+  nodes_[node].info = index;
+  by_type_[static_cast<std::uint8_t>(info.op_type)] = index;
+  if (info.text.size() > max_length_) max_length_ = info.text.size();
+}
+
+std::size_t OperatorRegistry::NewNodes(std::string_view text) const {
+  std::size_t node = 0;
+  std::size_t matched = 0;
+  for (char ch : text) {
+    node = nodes_[node].children[static_cast<unsigned char>(ch)];
+    if (node == 0) break;
+    matched++;
+  }
+  return text.size() - matched;
+}
+
+OperatorType OperatorRegistry::RegisterInfix(std::string_view text,
+                                             int precedence,
+                                             Associativity associativity) {
+  std::stringstream ss_register_err_msg;
+  ss_register_err_msg << "Operator \'" << text << "\' can't be registered: ";
+
+  if (text.empty()) {
+    ss_register_err_msg << "it is empty";
+    throw OperatorRegistrationException(ss_register_err_msg.str());
+  }
+  for (char ch : text) {
+    // Other bytes start identifiers, numbers, strings or whitespace
+    bool punctuation = (ch >= '!' && ch <= '/') || (ch >= ':' && ch <= '@') ||
+                       (ch >= '[' && ch <= '`') || (ch >= '{' && ch <= '~');
+    if (!punctuation || ch == '"') {
+      ss_register_err_msg << "only ASCII punctuation other than \'\"\' is "
+                             "allowed";
+      throw OperatorRegistrationException(ss_register_err_msg.str());
+    }
+  }
+  if (Find(text) != nullptr) {
+    ss_register_err_msg << "it is already an operator";
+    throw OperatorRegistrationException(ss_register_err_msg.str());
+  }
+  if (precedence < kMinPrecedence || precedence > kMaxPrecedence) {
+    ss_register_err_msg << "the precedence must be between " << kMinPrecedence
+                        << " and " << kMaxPrecedence;
+    throw OperatorRegistrationException(ss_register_err_msg.str());
+  }
+  if (next_user_type_ >= static_cast<int>(by_type_.size())) {
+    ss_register_err_msg << "too many operators are registered";
+    throw OperatorRegistrationException(ss_register_err_msg.str());
+  }
+  if (nodes_.size() + NewNodes(text) > kMaxTrieNodes) {
+    ss_register_err_msg << "the registered operators are too long";
+    throw OperatorRegistrationException(ss_register_err_msg.str());
+  }
+
+  OperatorType op_type = static_cast<OperatorType>(next_user_type_++);
+  texts_.emplace_back(text);
+  Insert(OperatorInfo{texts_.back(), op_type, precedence, false, true,
+                      associativity});
+  return op_type;
+}
+
+const OperatorInfo *OperatorRegistry::Match(std::string_view text) const {
+  const OperatorInfo *longest = nullptr;
+  std::size_t node = 0;
+
+  for (char ch : text) {
+    unsigned char byte = static_cast<unsigned char>(ch);
+    if (byte >= 128) break;
+    node = nodes_[node].children[byte];
+    if (node == 0) break;
+    if (nodes_[node].info >= 0) longest = &infos_[nodes_[node].info];
+  }
+
+  return longest;
+}
+
+const OperatorInfo *OperatorRegistry::Find(std::string_view text) const {
+  const OperatorInfo *info = Match(text);
+  if (info == nullptr || info->text.size() != text.size()) return nullptr;
+  return info;
+}
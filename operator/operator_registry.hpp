@@ -0,0 +1,163 @@
+/**
+ * @file operator_registry.hpp
+ * @brief Contains the OperatorRegistry class, the set of operators known to
+ * the lexer and parser: the built-in ones (kOperatorTable) plus the infix
+ * operators registered at runtime
+ */
+#ifndef OPERATOR_REGISTRY_H
+#define OPERATOR_REGISTRY_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "operator.hpp"
+
+/**
+ * @brief Operators stored in a byte trie, so the longest operator at the
+ * beginning of a text is found in one walk over its bytes (O(operator
+ * length), nothing is copied). Operators of any length are supported, as
+ * long as the trie stays within kMaxTrieNodes nodes. Operators are spelled
+ * with ASCII punctuation, except the double quote.
+ */
+class OperatorRegistry {
+ public:
+  /**
+   * @brief Range of the precedence of a registered infix operator. The
+   * built-in ones go from 1 for "=" to 6 for "*", registered operators bind
+   * tighter than assignment.
+   */
+  static constexpr int kMinPrecedence = 2;
+  static constexpr int kMaxPrecedence = 100;
+
+  /**
+   * @brief Number of trie nodes the 16-bit child indices can reach, a node
+   * for every byte of every operator that does not share a prefix with
+   * another one
+   */
+  static constexpr std::size_t kMaxTrieNodes = 65536;
+
+ private:
+  struct TrieNode {
+    // Node reached by every ASCII byte, 0 if none (no node points back to
+    // the root, node 0)
+    std::array<std::uint16_t, 128> children{};
+    // Index in infos_ of the operator spelled by the path to the node, -1 if
+    // the path is only the beginning of longer operators
+    std::int16_t info = -1;
+  };
+
+  std::vector<TrieNode> nodes_;
+  // deques keep the entries (and the registered spellings infos_ refers to)
+  // in place as operators are added
+  std::deque<OperatorInfo> infos_;
+  std::deque<std::string> texts_;
+  // Index in infos_ of every OperatorType value, -1 for unused values
+  std::array<std::int16_t, 256> by_type_;
+  std::size_t max_length_;
+  int next_user_type_;
+
+  /**
+   * @brief Add an operator to the trie and the tables
+   * @param info the operator, its text must outlive the registry
+   */
+  void Insert(const OperatorInfo &info);
+
+  /**
+   * @brief Count the trie nodes an operator would add
+   * @param text the operator text
+   * @return std::size_t the number of bytes after its longest prefix in the
+   * trie
+   */
+  std::size_t NewNodes(std::string_view text) const;
+
+ public:
+  /**
+   * @brief Construct a registry holding the built-in operators
+   */
+  OperatorRegistry();
+
+  // The entries refer to the registry's own storage
+  OperatorRegistry(const OperatorRegistry &) = delete;
+  OperatorRegistry &operator=(const OperatorRegistry &) = delete;
+
+  /**
+   * @brief Get the shared registry of the built-in operators, used by the
+   * Lexer and Parser unless they are given another registry
+   * @return const OperatorRegistry & the built-in registry
+   */
+  static const OperatorRegistry &Builtin();
+
+  /**
+   * @brief Register a binary infix operator. The parser builds a
+   * BinaryExpression for it, grouped by its precedence and associativity.
+   * @param text the spelling of the operator (ASCII punctuation other than
+   * '"', not already an operator)
+   * @param precedence kMinPrecedence to kMaxPrecedence, higher binds tighter
+   * @param associativity how a chain of operators of this precedence groups
+   * @return OperatorType the type given to the operator's tokens
+   */
+  OperatorType RegisterInfix(std::string_view text, int precedence,
+                             Associativity associativity);
+
+  /**
+   * @brief Match the longest operator at the beginning of the text (maximal
+   * munch), e.g. "==1" matches "==" rather than "="
+   * @param text the text starting with the operator
+   * @return const OperatorInfo * the longest matching operator, nullptr if the
+   * text does not start with an operator
+   */
+  const OperatorInfo *Match(std::string_view text) const;
+
+  /**
+   * @brief Find the operator spelled exactly as the text
+   * @param text the operator text
+   * @return const OperatorInfo * the operator, nullptr if there is none
+   */
+  const OperatorInfo *Find(std::string_view text) const;
+
+  /**
+   * @brief Find the operator with the given OperatorType
+   * @param op_type the OperatorType to look for
+   * @return const OperatorInfo * the operator, nullptr if there is none
+   */
+  const OperatorInfo *Find(OperatorType op_type) const {
+    std::int16_t index = by_type_[static_cast<std::uint8_t>(op_type)];
+    return index < 0 ? nullptr : &infos_[index];
+  }
+
+  /**
+   * @brief Check if an operator starts with a byte
+   * @param ch the byte
+   * @return bool true if an operator starts with the byte
+   */
+  bool StartsOperator(char ch) const {
+    unsigned char byte = static_cast<unsigned char>(ch);
+    return byte < 128 && nodes_[0].children[byte] != 0;
+  }
+
+  /**
+   * @brief Get the length of the longest operator
+   * @return std::size_t the number of bytes of the longest operator
+   */
+  std::size_t MaxLength() const { return max_length_; }
+};
+
+/**
+ * @brief Exception thrown when an operator can't be registered
+ */
+class OperatorRegistrationException : public std::exception {
+ private:
+  std::string err_info_;
+
+ public:
+  OperatorRegistrationException(std::string err_info) : err_info_(err_info){};
+
+  const char *what() const noexcept override { return err_info_.c_str(); }
+};
+
+#endif
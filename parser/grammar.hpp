@@ -0,0 +1,84 @@
+/**
+ * @file grammar.hpp
+ * @brief The operator sets of the grammar levels, shared by the Parser (which
+ * builds the AST) and the Recognizer (which only checks the syntax)
+ *
+ * Program     := Statement* EOL
+ * Statement   := "set" Primary ["=" Expression] | Expression
+ * Expression  := Primary (INFIX_OPERATOR Primary)*
+ * Primary     := IDENTIFIER | NUMBER | STRING | "null" | "true" | "false"
+ *              | "(" Expression ")" | ("+" | "-")+ NUMBER | "!" Expression
+ *
+ * An Expression is grouped by the precedence and associativity of its
+ * infix operators (OperatorRegistry): "=" (1, right associative) < "==" "!="
+ * (2) < "+" "-" (5) < "*" "/" (6), the others left associative, plus the
+ * registered operators. The operand of "!" takes the operators from its
+ * precedence (1) on, so every one of them.
+ *
+ * The declared variable and the left hand side of "=" must be identifiers
+ * (possibly in parentheses).
+ */
+#ifndef GRAMMAR_H
+#define GRAMMAR_H
+
+#include "operator.hpp"
+#include "token.hpp"
+
+/**
+ * @brief Check if an infix operator builds a ComparisonExpression rather
+ * than a BinaryExpression
+ * @param op_type the OperatorType of the operator
+ * @return bool true for "==" and "!="
+ */
+constexpr bool IsComparisonOperator(OperatorType op_type) {
+  return op_type == OperatorType::EQUAL || op_type == OperatorType::NOT_EQUAL;
+}
+
+/**
+ * @brief Check if an operator is a sign of a number literal in Primary
+ * @param op_type the OperatorType of the next token
+ * @return bool true for "+" and "-"
+ */
+constexpr bool IsAdditionOperator(OperatorType op_type) {
+  return op_type == OperatorType::PLUS || op_type == OperatorType::MINUS;
+}
+
+/**
+ * @brief Get how an operator changes the nesting of parentheses and braces
+ * @param op_type the OperatorType of the token (OperatorType::INVALID for a
+ * token which is not an operator)
+ * @return int 1 for an opening one, -1 for a closing one, 0 otherwise
+ */
+constexpr int NestingChange(OperatorType op_type) {
+  switch (op_type) {
+    case OperatorType::L_PARENTHESIS:
+    case OperatorType::L_BRACE:
+      return 1;
+    case OperatorType::R_PARENTHESIS:
+    case OperatorType::R_BRACE:
+      return -1;
+    default:
+      return 0;
+  }
+}
+
+/**
+ * @brief Check if a token is a Primary on its own (a literal or identifier)
+ * @param tok_type the TokenType of the next token
+ * @return bool true if the token is the whole Primary
+ */
+constexpr bool IsAtom(TokenType tok_type) {
+  switch (tok_type) {
+    case TokenType::IDENTIFIER:
+    case TokenType::NUMBER:
+    case TokenType::STRING:
+    case TokenType::NULLABLE:
+    case TokenType::TRUE:
+    case TokenType::FALSE:
+      return true;
+    default:
+      return false;
+  }
+}
+
+#endif
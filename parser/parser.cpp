@@ -1,59 +1,489 @@
 #include "parser.hpp"
 
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <functional>
 #include <memory>
 #include <sstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "ast.hpp"
+#include "grammar.hpp"
+
+namespace {
+
+/**
+ * @brief Statements parsed by a worker of Parser::ProduceASTParallel from a
+ * chunk of the tokens
+ */
+struct ParsedChunk {
+  std::size_t begin;
+  std::size_t end;
+  Program program;
+  // Set if parsing failed
+  std::exception_ptr error;
+};
+
+/**
+ * @brief Parse the tokens [chunk.begin, chunk.end) with a Parser of its own
+ * @param operators the registry of the operators
+ * @param tokens the TokenBuffer holding the tokens
+ * @param chunk the chunk to parse, receives the statements
+ */
+void ParseChunk(const OperatorRegistry &operators, const TokenBuffer &tokens,
+                ParsedChunk &chunk) {
+  Parser parser = Parser();
+  parser.SetOperators(operators);
+  try {
+    chunk.program = parser.ProduceAST(tokens, chunk.begin, chunk.end);
+  } catch (...) {
+    chunk.error = std::current_exception();
+  }
+}
 
-Parser::Parser(){};
+}  // namespace
+
+Parser::Parser()
+    : tokens_(nullptr),
+      cursor_(0),
+      end_(0),
+      source_(nullptr),
+      last_eaten_(0),
+      discarded_(0),
+      statement_begin_(0),
+      program_(nullptr),
+      operators_(&OperatorRegistry::Builtin()),
+      errors_(nullptr){};
 Parser::~Parser(){};
 
-TokenPtr Parser::Eat() {
-  TokenPtr token = tok_queue_.front();
-  tok_queue_.pop();
-  return token;
+void Parser::Fill() {
+  // Only the last eaten token is still looked at, drop the ones before it
+  if (last_eaten_ >= kDiscardBatch) {
+    window_.DiscardFront(last_eaten_);
+    cursor_ -= last_eaten_;
+    discarded_ += last_eaten_;
+    last_eaten_ = 0;
+  }
+
+  source_->Pull(&window_);
+  end_ = window_.Size();
+}
+
+TokenType Parser::PeekType() {
+  if (cursor_ >= end_) {
+    if (source_ == nullptr) return TokenType::EOL;
+    Fill();
+  }
+  return tokens_->Type(cursor_);
+}
+
+OperatorType Parser::PeekOpType() {
+  if (PeekType() != TokenType::OPERATOR) return OperatorType::INVALID;
+  return tokens_->OpType(cursor_);
+}
+
+TokenPtr Parser::PeekToken() const {
+  if (cursor_ >= end_)
+    return GenerateToken("", TokenType::EOL, OperatorPtr(nullptr));
+  return tokens_->ToToken(cursor_);
+}
+
+void Parser::SkipWhitespace() {
+  while (PeekType() == TokenType::WHITESPACE) cursor_++;
+}
+
+std::size_t Parser::Eat() {
+  PeekType();
+  last_eaten_ = cursor_;
+  if (cursor_ < end_) cursor_++;
+  SkipWhitespace();
+  return last_eaten_;
 }
 
-TokenPtr Parser::Peek() { return tok_queue_.front(); }
+std::string_view Parser::EatText() {
+  PeekType();
+  if (cursor_ >= end_) return std::string_view();
+  return tokens_->Text(Eat());
+}
 
-TokenPtr Parser::ExpectedTokenType(OperatorType expected_type) {
-  TokenPtr curr_tok = Peek();
+std::size_t Parser::ExpectedTokenType(OperatorType expected_type) {
   std::stringstream invalid_tok_msg;
 
-  if (curr_tok->OpPtr()->Type() == expected_type) return curr_tok;
+  if (PeekOpType() == expected_type) return cursor_;
 
-  invalid_tok_msg << "Expected: \')\' Got Operator: \'" << *(curr_tok->OpPtr())
-                  << "\' is not allowed";
+  TokenPtr curr_tok = PeekToken();
+  if (curr_tok->OpPtr() == nullptr) {
+    invalid_tok_msg << "Expected: \')\' Got Token: \'" << *(curr_tok)
+                    << "\' is not allowed";
+  } else {
+    invalid_tok_msg << "Expected: \')\' Got Operator: \'"
+                    << *(curr_tok->OpPtr()) << "\' is not allowed";
+  }
   throw UnexpectedTokenParsedException(invalid_tok_msg.str());
 }
 
-TokenPtr Parser::ExpectedTokenType(TokenType expected_type) {
-  TokenPtr curr_tok = Peek();
+std::size_t Parser::ExpectedTokenType(TokenType expected_type) {
   std::stringstream invalid_tok_msg;
 
-  if (curr_tok->Type() == expected_type) return curr_tok;
-  invalid_tok_msg << "Expected: \')\' Got Token: \'" << *(curr_tok)
+  if (PeekType() == expected_type) return cursor_;
+  invalid_tok_msg << "Expected: \')\' Got Token: \'" << *(PeekToken())
                   << "\' is not allowed";
 
   throw UnexpectedTokenParsedException(invalid_tok_msg.str());
 }
 
-Program Parser::ProduceAST(std::queue<TokenPtr> &tok_queue) {
-  tok_queue_ = tok_queue;
-  Program program = Program();
+bool Parser::StartsLine(std::size_t index) const {
+  if (tokens_->LeadingTrivia(index).find('\n') != std::string_view::npos)
+    return true;
+  // The line break is in a whitespace token if the Lexer kept them
+  return index > 0 && tokens_->Type(index - 1) == TokenType::WHITESPACE &&
+         tokens_->Text(index - 1).find('\n') != std::string_view::npos;
+}
 
-  while (tok_queue_.front()->Type() != TokenType::EOL) {
-    program.body_.push(ParseStatement());
+void Parser::Synchronize(std::size_t statement_begin) {
+  // Parentheses and braces opened by the statement before the error
+  int depth = 0;
+  for (std::size_t i = statement_begin; i < cursor_; i++) {
+    depth = std::max(depth + NestingChange(tokens_->OpType(i)), 0);
+  }
+
+  // Resuming on the error token would report the same error again, unless
+  // it is a "set" starting the next statement
+  if (cursor_ < end_ && tokens_->Type(cursor_) != TokenType::EOL &&
+      (tokens_->Type(cursor_) != TokenType::SET ||
+       cursor_ == statement_begin)) {
+    depth = std::max(depth + NestingChange(tokens_->OpType(cursor_)), 0);
+    cursor_++;
   }
 
+  // "set" always starts a statement, the parentheses left open before it
+  // were missing their closing ones
+  while (cursor_ < end_ && tokens_->Type(cursor_) != TokenType::EOL) {
+    TokenType tok_type = tokens_->Type(cursor_);
+    if (tok_type == TokenType::SET ||
+        (depth == 0 && tok_type != TokenType::WHITESPACE &&
+         StartsLine(cursor_))) {
+      break;
+    }
+    depth = std::max(depth + NestingChange(tokens_->OpType(cursor_)), 0);
+    cursor_++;
+  }
+  last_eaten_ = cursor_;
+}
+
+std::vector<std::size_t> Parser::FindStatementCuts(
+    std::size_t chunk_count) const {
+  const std::size_t size = tokens_->Size();
+  std::vector<std::size_t> cuts = {0};
+  int depth = 0;
+  // Whether the last token (whitespace aside) ends a Primary
+  bool after_primary = false;
+
+  for (std::size_t i = 0; i < size && cuts.size() < chunk_count; i++) {
+    TokenType tok_type = tokens_->Type(i);
+    if (tok_type == TokenType::WHITESPACE) continue;
+
+    OperatorType op_type = tokens_->OpType(i);
+    const OperatorInfo *info = tok_type == TokenType::OPERATOR
+                                   ? operators_->Find(op_type)
+                                   : nullptr;
+    if (depth == 0 && after_primary && tok_type != TokenType::EOL &&
+        (info == nullptr || !info->infix) &&
+        i >= size / chunk_count * cuts.size() && StartsLine(i)) {
+      cuts.push_back(i);
+    }
+
+    depth = std::max(depth + NestingChange(op_type), 0);
+    after_primary =
+        IsAtom(tok_type) || op_type == OperatorType::R_PARENTHESIS;
+  }
+
+  cuts.push_back(size);
+  return cuts;
+}
+
+void Parser::ThrowNotAnIdentifier() const {
+  std::stringstream invalid_tok_msg;
+  invalid_tok_msg << "Expected an identifier before \'" << *(PeekToken())
+                  << "\'";
+  throw UnexpectedTokenParsedException(invalid_tok_msg.str());
+}
+
+Program Parser::ParseProgram() {
+  last_eaten_ = cursor_;
+  Program program = Program();
+  program_ = &program;
+  SkipWhitespace();
+
+  while (PeekType() != TokenType::EOL) AppendStatement(program);
+
   // Remove TokenType::EOL
   Eat();
 
+  program_ = nullptr;
+  return program;
+}
+
+void Parser::AppendStatement(Program &program) {
+  statement_begin_ = Position();
+
+  if (errors_ == nullptr) {
+    program.body_.push(ParseStatement());
+  } else {
+    std::size_t statement_begin = cursor_;
+    try {
+      program.body_.push(ParseStatement());
+    } catch (const UnexpectedTokenParsedException &e) {
+      std::size_t offset = cursor_ < tokens_->Size()
+                               ? tokens_->Offset(cursor_)
+                               : tokens_->Source().size();
+      errors_->push_back(ParseError{cursor_, offset, e.what()});
+      Synchronize(statement_begin);
+      return;
+    }
+  }
+
+  // The statement ends where the parser looked for the next one
+  PeekType();
+  program.statement_ranges_.push_back(
+      TokenRange{static_cast<std::uint32_t>(statement_begin_),
+                 static_cast<std::uint32_t>(Position())});
+}
+
+Program Parser::ProduceAST(const TokenBuffer &tokens) {
+  return ProduceAST(tokens, 0, tokens.Size());
+}
+
+Program Parser::ProduceAST(const TokenBuffer &tokens, std::size_t begin,
+                           std::size_t end) {
+  tokens_ = &tokens;
+  source_ = nullptr;
+  end_ = std::min(end, tokens.Size());
+  cursor_ = std::min(begin, end_);
+  discarded_ = 0;
+  Program program = ParseProgram();
+
+  tokens_ = nullptr;
+  return program;
+}
+
+ParseResult Parser::ProduceASTWithErrors(const TokenBuffer &tokens) {
+  ParseResult result;
+  errors_ = &result.errors;
+  try {
+    result.program = ProduceAST(tokens);
+  } catch (...) {
+    errors_ = nullptr;
+    throw;
+  }
+
+  errors_ = nullptr;
+  return result;
+}
+
+Program Parser::ProduceASTParallel(const TokenBuffer &tokens,
+                                   unsigned thread_count,
+                                   std::size_t min_chunk_size) {
+  if (thread_count == 0) thread_count = std::thread::hardware_concurrency();
+  if (min_chunk_size == 0) min_chunk_size = 1;
+
+  std::size_t chunk_count =
+      std::min<std::size_t>(thread_count, tokens.Size() / min_chunk_size);
+  if (chunk_count <= 1) return ProduceAST(tokens);
+
+  tokens_ = &tokens;
+  std::vector<std::size_t> cuts = FindStatementCuts(chunk_count);
+  tokens_ = nullptr;
+  if (cuts.size() <= 2) return ProduceAST(tokens);
+
+  std::vector<ParsedChunk> chunks;
+  chunks.reserve(cuts.size() - 1);
+  for (std::size_t i = 0; i + 1 < cuts.size(); i++)
+    chunks.push_back({cuts[i], cuts[i + 1], Program(), nullptr});
+
+  std::vector<std::thread> workers;
+  workers.reserve(chunks.size() - 1);
+  for (std::size_t i = 1; i < chunks.size(); i++) {
+    try {
+      workers.emplace_back(ParseChunk, std::cref(*operators_),
+                           std::cref(tokens), std::ref(chunks[i]));
+    } catch (const std::system_error &) {
+      // No thread left, parse the remaining chunks on this one (the started
+      // workers are still joined below)
+      for (std::size_t j = i; j < chunks.size(); j++)
+        ParseChunk(*operators_, tokens, chunks[j]);
+      break;
+    }
+  }
+  ParseChunk(*operators_, tokens, chunks[0]);
+  for (std::thread &worker : workers) worker.join();
+
+  for (std::size_t i = 0; i < chunks.size(); i++) {
+    // "set a" is only complete before TokenType::EOL, parsed in order it
+    // fails on the token after it
+    bool incomplete = false;
+    if (i + 1 < chunks.size() && !chunks[i].program.body_.empty()) {
+      StatementPtr last = chunks[i].program.body_.back();
+      incomplete = last->Type() == NodeType::VariableDeclarationStmt &&
+                   !static_cast<VariableDeclarationStatement *>(last)
+                        ->HasValue();
+    }
+    if (chunks[i].error != nullptr || incomplete) return ProduceAST(tokens);
+  }
+
+  Program program = std::move(chunks[0].program);
+  for (std::size_t i = 1; i < chunks.size(); i++)
+    program.Append(chunks[i].program);
   return program;
 }
 
+Program Parser::Reparse(const Program &previous, const TokenBuffer &tokens,
+                        const TokenEdit &edit) {
+  // Only a Program produced by the Parser knows where its statements are, and
+  // the edit must turn its tokens (up to the EOL token) into the new ones
+  const std::vector<TokenRange> &ranges = previous.statement_ranges_;
+  std::size_t old_size = ranges.empty() ? 0 : ranges.back().end + 1;
+  if (ranges.empty() || ranges.size() != previous.body_.size() ||
+      edit.begin + edit.removed > old_size ||
+      old_size - edit.removed + edit.inserted != tokens.Size()) {
+    return ProduceAST(tokens);
+  }
+
+  // The result keeps the arenas of the previous Program alive, with the nodes
+  // of the statements it replaced, so a chain of reparses keeps growing. Once
+  // they use several times the bytes of a compact Program, parse everything
+  // again so they can be freed.
+  if (previous.RetainedBytes() > kMaxReparseGrowth * previous.CompactBytes())
+    return ProduceAST(tokens);
+
+  std::vector<StatementPtr> statements;
+  statements.reserve(previous.body_.size());
+  for (std::queue<StatementPtr> pending = previous.body_; !pending.empty();
+       pending.pop()) {
+    statements.push_back(pending.front());
+  }
+
+  // Statements which did not look at the edited tokens are kept as they are
+  Program program = previous.Extending();
+  std::size_t kept = 0;
+  while (kept < statements.size() && ranges[kept].end < edit.begin) {
+    program.body_.push(statements[kept]);
+    program.statement_ranges_.push_back(ranges[kept]);
+    kept++;
+  }
+
+  // Statements from the end of the edit on are kept as well once the parser
+  // reaches the start of one: the tokens from there are the same
+  const std::size_t edit_end = edit.begin + edit.removed;
+  std::size_t reused = kept;
+  while (reused < statements.size() && ranges[reused].begin < edit_end) {
+    reused++;
+  }
+
+  tokens_ = &tokens;
+  source_ = nullptr;
+  end_ = tokens.Size();
+  discarded_ = 0;
+  cursor_ = std::min<std::size_t>(kept > 0 ? ranges[kept - 1].end : 0, end_);
+  last_eaten_ = cursor_;
+  program_ = &program;
+  SkipWhitespace();
+
+  while (PeekType() != TokenType::EOL) {
+    while (reused < statements.size() &&
+           ranges[reused].begin + edit.inserted - edit.removed < cursor_) {
+      reused++;
+    }
+    if (reused < statements.size() &&
+        ranges[reused].begin + edit.inserted - edit.removed == cursor_) {
+      for (; reused < statements.size(); reused++) {
+        program.body_.push(statements[reused]);
+        program.statement_ranges_.push_back(TokenRange{
+            static_cast<std::uint32_t>(ranges[reused].begin + edit.inserted -
+                                       edit.removed),
+            static_cast<std::uint32_t>(ranges[reused].end + edit.inserted -
+                                       edit.removed)});
+      }
+      break;
+    }
+
+    AppendStatement(program);
+  }
+
+  program_ = nullptr;
+  tokens_ = nullptr;
+  return program;
+}
+
+Program Parser::ProduceAST(TokenSource &source) {
+  window_ = source.EmptyBuffer();
+  tokens_ = &window_;
+  source_ = &source;
+  cursor_ = 0;
+  end_ = 0;
+  discarded_ = 0;
+  Program program = ParseProgram();
+
+  window_.Clear();
+  tokens_ = nullptr;
+  source_ = nullptr;
+  return program;
+}
+
+Program Parser::ProduceAST(std::span<const TokenPtr> tok_list) {
+  // Lay the token texts out one after another, so the TokenBuffer can refer
+  // to them like it refers to a lexed source
+  std::shared_ptr<std::string> source = std::make_shared<std::string>();
+  for (const TokenPtr &tok : tok_list) {
+    if (tok->Type() == TokenType::STRING) {
+      source->append("\"" + tok->Text() + "\"");
+    } else {
+      source->append(tok->Text());
+    }
+  }
+
+  TokenBuffer tokens = TokenBuffer(std::shared_ptr<const std::string>(source));
+  tokens.Reserve(tok_list.size());
+
+  std::uint32_t offset = 0;
+  for (const TokenPtr &tok : tok_list) {
+    std::uint32_t length = static_cast<std::uint32_t>(tok->Text().size());
+    if (tok->Type() == TokenType::STRING) length += 2;
+
+    OperatorType op_type = OperatorType::INVALID;
+    if (tok->OpPtr() != nullptr) op_type = tok->OpPtr()->Type();
+
+    if (tok->Type() == TokenType::NUMBER) {
+      tokens.AppendNumber(offset, length, tok->Number());
+    } else {
+      tokens.Append(tok->Type(), offset, length, op_type);
+    }
+    offset += length;
+  }
+  tokens.SetOperators(*operators_);
+
+  return ProduceAST(tokens);
+}
+
+Program Parser::ProduceAST(const std::queue<TokenPtr> &tok_queue) {
+  // A queue can only be walked by popping a copy of it
+  std::vector<TokenPtr> tok_list;
+  tok_list.reserve(tok_queue.size());
+  for (std::queue<TokenPtr> pending = tok_queue; !pending.empty();
+       pending.pop()) {
+    tok_list.push_back(std::move(pending.front()));
+  }
+
+  return ProduceAST(std::span<const TokenPtr>(tok_list));
+}
+
 StatementPtr Parser::ParseStatement() {
-  switch (Peek()->Type()) {
+  switch (PeekType()) {
     case TokenType::SET:
       return ParseIdentifierDeclarationExpression();
     default:
@@ -61,203 +491,146 @@ StatementPtr Parser::ParseStatement() {
   }
 }
 
-ExpressionPtr Parser::ParseExpression() {
-  return ParseIdentifierAssignmentExpression();
-}
-
 ExpressionPtr Parser::ParsePrimaryExpression() {
   std::stringstream ssInvalidTokMsg;
   ExpressionPtr returned_expr;
+  const std::size_t begin = Position();
 
   // How it works: Read one token (then pop the queue) to convert to an
   // expression.
 
-  TokenPtr curr_tok = Peek();
-  switch (curr_tok->Type()) {
+  switch (PeekType()) {
     case TokenType::IDENTIFIER:
-      returned_expr = ExpressionPtr(new IdentifierExpression(Eat()->Text()));
+      returned_expr = program_->New<IdentifierExpression>(
+          program_->CopyText(EatText()));
       break;
     case TokenType::NUMBER:
       returned_expr =
-          ExpressionPtr(new NumberExpression(std::stod(Eat()->Text())));
-      break;
-    case TokenType::WHITESPACE:
-      returned_expr = ExpressionPtr(new WhitespaceExpression(Eat()->Text()));
+          program_->New<NumberExpression>(tokens_->Number(Eat()));
       break;
     case TokenType::NULLABLE:
       Eat();
-      returned_expr = ExpressionPtr(new NullExpression());
+      returned_expr = program_->New<NullExpression>();
       break;
     case TokenType::TRUE:
     case TokenType::FALSE:
-      returned_expr = ExpressionPtr(new BooleanExpression(Eat()->Text()));
+      returned_expr =
+          program_->New<BooleanExpression>(program_->CopyText(EatText()));
       break;
     case TokenType::STRING:
-      returned_expr = ExpressionPtr(new StringExpression(Eat()->Text()));
+      returned_expr =
+          program_->New<StringExpression>(program_->CopyText(EatText()));
       break;
     case TokenType::OPERATOR:
-      switch (Peek()->OpPtr()->Type()) {
+      switch (PeekOpType()) {
         case OperatorType::L_PARENTHESIS:
           Eat();
-          ParseWhitespaceExpression();
           returned_expr = ParseExpression();
-          ParseWhitespaceExpression();
           ExpectedTokenType(OperatorType::R_PARENTHESIS);
           Eat();
-          break;
+          // The parentheses are not part of the node, it keeps its range
+          return returned_expr;
         case OperatorType::PLUS:
         case OperatorType::MINUS: {
           int sign = 1;
-          while (Peek()->Type() == TokenType::OPERATOR &&
-                 (Peek()->OpPtr()->Type() == OperatorType::PLUS ||
-                  Peek()->OpPtr()->Type() == OperatorType::MINUS)) {
-            if (Peek()->OpPtr()->Type() == OperatorType::MINUS) {
+          while (IsAdditionOperator(PeekOpType())) {
+            if (PeekOpType() == OperatorType::MINUS) {
               sign *= -1;
             }
             Eat();
-            ParseWhitespaceExpression();
           }
           ExpectedTokenType(TokenType::NUMBER);
-          returned_expr = ExpressionPtr(
-              new NumberExpression(sign * std::stod(Eat()->Text())));
+          returned_expr =
+              program_->New<NumberExpression>(sign * tokens_->Number(Eat()));
           break;
         }
         case OperatorType::NOT: {
           Eat();
-          ParseWhitespaceExpression();
-          returned_expr = ExpressionPtr(new NotExpression(ParseExpression()));
-          ParseWhitespaceExpression();
+          const int operand_precedence =
+              operators_->Find(OperatorType::NOT)->precedence;
+          returned_expr = program_->New<NotExpression>(
+              ParseExpression(operand_precedence));
           break;
         }
         default:
-          ssInvalidTokMsg << "Unexpected Operator: \'" << *(curr_tok->OpPtr())
-                          << "\' is not allowed";
+          ssInvalidTokMsg << "Unexpected Operator: \'"
+                          << *(PeekToken()->OpPtr()) << "\' is not allowed";
           throw UnexpectedTokenParsedException(ssInvalidTokMsg.str());
       };
       break;
     default:
-      ssInvalidTokMsg << "Unexpected Token: \'" << *curr_tok
+      ssInvalidTokMsg << "Unexpected Token: \'" << *(PeekToken())
                       << "\' is not allowed";
       throw UnexpectedTokenParsedException(ssInvalidTokMsg.str());
       break;
   }
-  return returned_expr;
+  return Track(returned_expr, begin);
 }
 
-ExpressionPtr Parser::ParseAdditionExpression() {
-  ExpressionPtr left = ParseMultiplicationExpression();
-  ParseWhitespaceExpression();
-
-  TokenPtr curr_tok = Peek();
-  while (curr_tok->Type() == TokenType::OPERATOR &&
-         (curr_tok->OpPtr()->Type() == OperatorType::PLUS ||
-          curr_tok->OpPtr()->Type() == OperatorType::MINUS)) {
-    const std::string op_val = Eat()->Text();
-    ParseWhitespaceExpression();
-    ExpressionPtr right = ParseMultiplicationExpression();
-    ParseWhitespaceExpression();
-
-    left = ExpressionPtr(new BinaryExpression(left, op_val, right));
-    curr_tok = Peek();
-  }
-
-  return left;
+const OperatorInfo *Parser::PeekInfix() {
+  if (PeekType() != TokenType::OPERATOR) return nullptr;
+  const OperatorInfo *info = operators_->Find(PeekOpType());
+  if (info == nullptr || !info->infix) return nullptr;
+  return info;
 }
 
-ExpressionPtr Parser::ParseMultiplicationExpression() {
+ExpressionPtr Parser::ParseExpression(int min_precedence) {
+  const std::size_t begin = Position();
   ExpressionPtr left = ParsePrimaryExpression();
-  ParseWhitespaceExpression();
-
-  TokenPtr curr_tok = Peek();
-  while (curr_tok->Type() == TokenType::OPERATOR &&
-         (curr_tok->OpPtr()->Type() == OperatorType::STAR ||
-          curr_tok->OpPtr()->Type() == OperatorType::SLASH)) {
-    const std::string op_val = Eat()->Text();
-    ParseWhitespaceExpression();
-    ExpressionPtr right = ParsePrimaryExpression();
-    ParseWhitespaceExpression();
-
-    left = ExpressionPtr(new BinaryExpression(left, op_val, right));
-    curr_tok = Peek();
+
+  // Precedence climbing: the right operand takes the operators binding
+  // tighter than this one (or as tight, for a right associative one)
+  while (true) {
+    const OperatorInfo *info = PeekInfix();
+    if (info == nullptr || info->precedence < min_precedence) break;
+
+    IdentifierExpression *var_expr = nullptr;
+    if (info->op_type == OperatorType::ASSIGN) {
+      if (left->Type() != NodeType::IdentifierExpr) ThrowNotAnIdentifier();
+      var_expr = static_cast<IdentifierExpression *>(left);
+    }
+
+    const std::string_view op_val = program_->CopyText(EatText());
+    int right_precedence = info->associativity == Associativity::LEFT
+                               ? info->precedence + 1
+                               : info->precedence;
+    ExpressionPtr right = ParseExpression(right_precedence);
+
+    if (var_expr != nullptr) {
+      left = program_->New<VariableAssignExpression>(var_expr->identifier_,
+                                                     right);
+    } else if (IsComparisonOperator(info->op_type)) {
+      left = program_->New<ComparisonExpression>(left, op_val, right);
+    } else {
+      left = program_->New<BinaryExpression>(left, op_val, right);
+    }
+    Track(left, begin);
   }
 
   return left;
 }
 
-ExpressionPtr Parser::ParseWhitespaceExpression() {
-  if (Peek()->Type() == TokenType::WHITESPACE)
-    return ExpressionPtr(new WhitespaceExpression(Eat()->Text()));
-
-  return ExpressionPtr(nullptr);
-}
-
 StatementPtr Parser::ParseIdentifierDeclarationExpression() {
+  const std::size_t begin = Position();
   ExpectedTokenType(TokenType::SET);
   Eat();
-  ParseWhitespaceExpression();
 
   ExpressionPtr parsedVar = ParsePrimaryExpression();
-  std::shared_ptr<IdentifierExpression> var_expr =
-      std::dynamic_pointer_cast<IdentifierExpression>(parsedVar);
-  ParseWhitespaceExpression();
+  if (parsedVar->Type() != NodeType::IdentifierExpr) ThrowNotAnIdentifier();
+  IdentifierExpression *var_expr =
+      static_cast<IdentifierExpression *>(parsedVar);
 
-  if (Peek()->Type() == TokenType::EOL)
-    return std::make_shared<VariableDeclarationStatement>(
-        var_expr->identifier_);
+  if (PeekType() == TokenType::EOL)
+    return Track(
+        program_->New<VariableDeclarationStatement>(var_expr->identifier_),
+        begin);
 
   ExpectedTokenType(OperatorType::ASSIGN);
   Eat();
-  ParseWhitespaceExpression();
 
   ExpressionPtr value = ParseExpression();
-  ParseWhitespaceExpression();
-
-  return std::make_shared<VariableDeclarationStatement>(var_expr->identifier_,
-                                                        value);
-}
-
-ExpressionPtr Parser::ParseIdentifierAssignmentExpression() {
-  // Can be an identifier
-  ExpressionPtr left = ParseComparisonExpression();
-
-  ParseWhitespaceExpression();
-
-  TokenPtr curr_tok = Peek();
-  if (curr_tok->Type() == TokenType::OPERATOR &&
-      curr_tok->OpPtr()->Type() == OperatorType::ASSIGN) {
-    Eat();
 
-    ParseWhitespaceExpression();
-
-    std::shared_ptr<IdentifierExpression> var_expr =
-        std::dynamic_pointer_cast<IdentifierExpression>(left);
-
-    ExpressionPtr value = ParseIdentifierAssignmentExpression();
-    ParseWhitespaceExpression();
-
-    return std::make_shared<VariableAssignExpression>(var_expr->identifier_,
-                                                      value);
-  }
-
-  return left;
-}
-
-ExpressionPtr Parser::ParseComparisonExpression() {
-  ExpressionPtr left = ParseAdditionExpression();
-  ParseWhitespaceExpression();
-
-  TokenPtr next_tok = Peek();
-  while (next_tok->Type() == TokenType::OPERATOR &&
-         (next_tok->OpPtr()->Type() == OperatorType::NOT_EQUAL ||
-          next_tok->OpPtr()->Type() == OperatorType::EQUAL)) {
-    const std::string op_val = Eat()->Text();
-    ParseWhitespaceExpression();
-    ExpressionPtr right = ParsePrimaryExpression();
-    ParseWhitespaceExpression();
-
-    left = ExpressionPtr(new ComparisonExpression(left, op_val, right));
-    next_tok = Peek();
-  }
-
-  return left;
+  return Track(program_->New<VariableDeclarationStatement>(
+                   var_expr->identifier_, value),
+               begin);
 }
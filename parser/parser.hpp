@@ -6,42 +6,215 @@
 #ifndef PARSER_H
 #define PARSER_H
 
+#include <cstddef>
+#include <cstdint>
 #include <queue>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "ast.hpp"
+#include "operator_registry.hpp"
 #include "token.hpp"
+#include "token_buffer.hpp"
+#include "token_source.hpp"
 
 /**
- * @brief The Parser class that takes in a queue of Token and produces an AST Statement and Expression
+ * @brief A syntax error reported by Parser::ProduceASTWithErrors
+ */
+struct ParseError {
+  // Index of the token the error was found at
+  std::size_t token;
+  // Byte offset of that token in the source (the size of the source if the
+  // tokens ran out)
+  std::size_t offset;
+  // Description of the error, as thrown by Parser::ProduceAST
+  std::string message;
+};
+
+/**
+ * @brief Result of Parser::ProduceASTWithErrors
+ */
+struct ParseResult {
+  // The statements parsed without error, in program order
+  Program program;
+  // Every syntax error in source order, empty for a valid program
+  std::vector<ParseError> errors;
+};
+
+/**
+ * @brief A token-level edit, for Parser::Reparse: the tokens [begin, begin +
+ * removed) of the previous TokenBuffer were replaced by inserted tokens
+ */
+struct TokenEdit {
+  std::size_t begin;
+  std::size_t removed;
+  std::size_t inserted;
+};
+
+/**
+ * @brief The Parser class that takes in a TokenBuffer (or a TokenSource, or a queue of Token) and produces an AST Statement and Expression
  */
 class Parser {
  private:
-  std::queue<TokenPtr> tok_queue_;
+  const TokenBuffer *tokens_;
+  // Index of the next token, the tokens from end_ on are not parsed (as if
+  // the TokenType::EOL token was there)
+  std::size_t cursor_;
+  std::size_t end_;
+
+  // When parsing from a TokenSource, tokens are pulled into window_ as the
+  // cursor reaches its end. Only the tokens from the last eaten one on are
+  // kept (in batches of kDiscardBatch), so memory does not grow with the input.
+  static constexpr std::size_t kDiscardBatch = 64;
+  TokenSource *source_;
+  TokenBuffer window_;
+  std::size_t last_eaten_;
+  // Number of tokens dropped from the front of the window, so cursor_ +
+  // discarded_ is the position of the next token in the whole token stream
+  std::size_t discarded_;
+
+  // Position of the first token of the statement being parsed, the token
+  // ranges of its nodes are counted from it
+  std::size_t statement_begin_;
+
+  // The Program being parsed, which owns the nodes
+  Program *program_;
+
+  // The operators of the language, the infix ones are parsed by their
+  // precedence and associativity
+  const OperatorRegistry *operators_;
+
+  // Where the syntax errors are collected, nullptr to throw the first one
+  std::vector<ParseError> *errors_;
+
+  /**
+   * @brief Pull the next token from the TokenSource into the window
+   */
+  void Fill();
+
+  /**
+   * @brief Skip the rest of a statement which failed to parse: advance past
+   * the token at the cursor (where the error was found) to the next token
+   * which starts a statement, "set" or the first token of a line outside the
+   * parentheses and braces the statement opened
+   * @param statement_begin the index of the first token of the statement
+   */
+  void Synchronize(std::size_t statement_begin);
+
+  /**
+   * @brief Find where to cut the tokens into chunks of whole statements: the
+   * first statement start past each equal share. A token starts a statement
+   * when it is the first of a line, outside parentheses and braces, not an
+   * infix operator, and follows the end of a Primary (so the statement
+   * before it cannot go on).
+   * @param chunk_count the number of chunks wanted
+   * @return std::vector<std::size_t> the first token of each chunk, followed
+   * by the number of tokens (fewer chunks if the statements are too long)
+   */
+  std::vector<std::size_t> FindStatementCuts(std::size_t chunk_count) const;
 
   /**
-   * @brief Preview the next token
+   * @brief Check if a token is preceded by a line break
+   * @param index the index of the token
+   * @return bool true if the token is the first of a line
    */
-  TokenPtr Peek();
+  bool StartsLine(std::size_t index) const;
+
+  /**
+   * @brief Parse statements up to the TokenType::EOL token
+   * @return Program the AST Program
+   */
+  Program ParseProgram();
+
+  /**
+   * @brief Parse the next statement into a Program, with its token range (or
+   * record the syntax error and skip the statement when collecting errors)
+   * @param program the Program to add the statement to
+   */
+  void AppendStatement(Program &program);
+
+  /**
+   * @brief Get the position of the next token in the token stream
+   * @return std::size_t the index of the next token, counting the tokens
+   * already dropped from the window
+   */
+  std::size_t Position() const { return cursor_ + discarded_; }
+
+  /**
+   * @brief Record the tokens a node was parsed from, up to the last eaten one
+   * @param node the node just parsed
+   * @param begin the position of its first token
+   * @return T * the node
+   */
+  template <typename T>
+  T *Track(T *node, std::size_t begin) const {
+    node->token_range_ = TokenRange{
+        static_cast<std::uint32_t>(begin - statement_begin_),
+        static_cast<std::uint32_t>(last_eaten_ + discarded_ + 1 -
+                                   statement_begin_)};
+    return node;
+  }
+
+  /**
+   * @brief Preview the TokenType of the next token
+   * @return TokenType the type of the next token (TokenType::EOL past the end)
+   */
+  TokenType PeekType();
+
+  /**
+   * @brief Preview the OperatorType of the next token
+   * @return OperatorType the operator type of the next token
+   * (OperatorType::INVALID if it is not an operator)
+   */
+  OperatorType PeekOpType();
+
+  /**
+   * @brief Build the next token as a standalone Token (for error messages)
+   * @return TokenPtr the next token
+   */
+  TokenPtr PeekToken() const;
 
   /**
    * @brief Check if the next token is the expected TokenType
    * @param expected_tok_type the expected TokenType
-   * @return TokenPtr the next token
+   * @return std::size_t the index of the next token
    */
-  TokenPtr ExpectedTokenType(TokenType expected_tok_type);
+  std::size_t ExpectedTokenType(TokenType expected_tok_type);
 
   /**
    * @brief Check if the next token is the expected OperatorType
    * @param expected_op_type the expected OperatorType
-   * @return TokenPtr the next token
+   * @return std::size_t the index of the next token
    */
-  TokenPtr ExpectedTokenType(OperatorType expected_op_type);
+  std::size_t ExpectedTokenType(OperatorType expected_op_type);
 
   /**
-   * @brief Return the peeked value and pops the tok_queue (Token Queue)
-   * @return TokenPtr the next token
+   * @brief Report a declared or assigned expression which is not an
+   * identifier (the next token follows the expression)
+   */
+  [[noreturn]] void ThrowNotAnIdentifier() const;
+
+  /**
+   * @brief Advance past whitespace tokens (only present if the Lexer kept
+   * them), so the parse functions never see whitespace
+   */
+  void SkipWhitespace();
+
+  /**
+   * @brief Return the index of the next token and advance past it (and the
+   * whitespace after it)
+   * @return std::size_t the index of the next token, valid until the next
+   * call to Eat()
    */
-  TokenPtr Eat();
+  std::size_t Eat();
+
+  /**
+   * @brief Return the text of the next token and advance past it
+   * @return std::string_view the text of the next token
+   */
+  std::string_view EatText();
 
   /**
    * @brief Parse the program
@@ -49,10 +222,15 @@ class Parser {
    */
   StatementPtr ParseStatement();
   /**
-   * @brief Parse the Expression
+   * @brief Parse an Expression: a Primary followed by infix operations,
+   * grouped by the precedence and associativity of their operators
+   * (assignment, comparison, addition, multiplication and the registered
+   * infix operators)
+   * @param min_precedence the lowest precedence of the operators to take, the
+   * others are left to the caller (0 takes every operator)
    * @return The Expression parsed
    */
-  ExpressionPtr ParseExpression();
+  ExpressionPtr ParseExpression(int min_precedence = 0);
 
   /**
    * @brief Reads the token and assign the value as expression
@@ -61,54 +239,140 @@ class Parser {
   ExpressionPtr ParsePrimaryExpression();
 
   /**
-   * @brief Parse the addition and subtraction operations
-   * @return ExpressionPtr the expression parsed
+   * @brief Preview the next token as an infix operator
+   * @return const OperatorInfo * the operator, nullptr if the next token is
+   * not an infix operator
    */
-  ExpressionPtr ParseAdditionExpression();
+  const OperatorInfo *PeekInfix();
 
   /**
-   * @brief Parse the multiplication and division operations
-   * @return ExpressionPtr the expression parsed
+   * @brief Parse the identifier declaration (Refer: Evaluater::EvaluateDefiningIdentifierExpression)
+   * @return StatementPtr the statement parsed
    */
-  ExpressionPtr ParseMultiplicationExpression();
+  StatementPtr ParseIdentifierDeclarationExpression();
 
+ public:
   /**
-   * @brief Parse the whitespaces
-   * @return ExpressionPtr the expression parsed
+   * @brief Construct a new Parser object
    */
-  ExpressionPtr ParseWhitespaceExpression();
+  Parser();
+  ~Parser();
 
   /**
-   * @brief Parse the identifier declaration (Refer: Evaluater::EvaluateDefiningIdentifierExpression)
-   * @return StatementPtr the statement parsed
+   * @brief Choose the operators the parser knows (by default
+   * OperatorRegistry::Builtin()), the same registry as the Lexer's
+   * @pre The registry must outlive the Parser
+   * @param operators the registry of the operators
    */
-  StatementPtr ParseIdentifierDeclarationExpression();
+  void SetOperators(const OperatorRegistry &operators) {
+    operators_ = &operators;
+  }
 
   /**
-   * @brief Parse the identifier assignment (Refer: Evaluater::EvaluateAssignIdentifierExpression)
-   * @return ExpressionPtr the statement parsed
+   * @brief Convert the List of Tokens to List of AST nodes(Statement and Expression).
+   * @param tokens the TokenBuffer to be converted to list of AST nodes (Statement and Expression)
+   * @return Program the list of AST (Statements and Expressions)
    */
-  ExpressionPtr ParseIdentifierAssignmentExpression();
+  Program ProduceAST(const TokenBuffer &tokens);
 
   /**
-   * @brief Parse the comparison operations
-   * @return ExpressionPtr the expression parsed
+   * @brief Convert a range of tokens of a TokenBuffer to AST nodes. The tokens
+   * are only read, so the same buffer can be parsed any number of times (or by
+   * several Parsers at once).
+   * @param tokens the TokenBuffer holding the tokens
+   * @param begin the index of the first token to parse
+   * @param end the index past the last token to parse, the parsing stops at a
+   * TokenType::EOL token before it
+   * @return Program the list of AST (Statements and Expressions)
    */
-  ExpressionPtr ParseComparisonExpression();
+  Program ProduceAST(const TokenBuffer &tokens, std::size_t begin,
+                     std::size_t end);
 
- public:
   /**
-   * @brief Construct a new Parser object
+   * @brief Convert a TokenBuffer to AST nodes, reporting every syntax error
+   * instead of throwing the first one. After an error the parser skips to the
+   * next statement (see Synchronize) and goes on, so the result holds the
+   * AST of the valid statements.
+   * @param tokens the TokenBuffer holding the tokens
+   * @return ParseResult the statements parsed and the errors found
    */
-  Parser();
-  ~Parser();
+  ParseResult ProduceASTWithErrors(const TokenBuffer &tokens);
+
+  /**
+   * @brief Default minimum number of tokens parsed by each thread of
+   * ProduceASTParallel()
+   */
+  static constexpr std::size_t kMinParallelChunkSize = 16 * 1024;
+
+  /**
+   * @brief Convert a TokenBuffer to AST nodes like ProduceAST(tokens),
+   * parsing chunks of whole statements (see FindStatementCuts) on their own
+   * threads and joining them in program order. On a syntax error the tokens
+   * are parsed again in order, to throw the same error as ProduceAST.
+   * @param tokens the TokenBuffer holding the tokens, only read
+   * @param thread_count the maximum number of threads, 0 for one per hardware
+   * thread
+   * @param min_chunk_size the minimum number of tokens per thread, smaller
+   * inputs use fewer threads
+   * @return Program the same AST as ProduceAST(tokens)
+   */
+  Program ProduceASTParallel(const TokenBuffer &tokens,
+                             unsigned thread_count = 0,
+                             std::size_t min_chunk_size =
+                                 kMinParallelChunkSize);
+
+  /**
+   * @brief Growth of the arenas kept alive by a chain of Reparse() calls,
+   * relative to a Program parsed in one go, after which Reparse() parses the
+   * whole TokenBuffer again
+   */
+  static constexpr std::size_t kMaxReparseGrowth = 4;
+
+  /**
+   * @brief Parse a TokenBuffer again after an edit, reusing the statements of
+   * the previous Program the edit cannot change: the ones whose tokens (and
+   * the token looked at after them) are all before the edit, and the ones
+   * after it once the parser reaches the start of one of them. Only the
+   * statements around the edit are parsed (all of them if the edit does not
+   * match the sizes of the token buffers). The new nodes go to an arena of
+   * the result, which also keeps the previous arenas alive: memory grows
+   * with every edit until the arenas use kMaxReparseGrowth times the bytes of
+   * a compact Program, then the whole buffer is parsed again.
+   * @pre The tokens were lexed as the previous ones (same operators and
+   * whitespace setting), and previous was produced by ProduceAST (or
+   * Reparse) from them
+   * @param previous the Program parsed from the tokens before the edit, its
+   * nodes are shared with the result (and left unchanged, so it can be
+   * reparsed on several threads at once)
+   * @param tokens the TokenBuffer after the edit
+   * @param edit where the tokens changed
+   * @return Program the same AST as ProduceAST(tokens)
+   */
+  Program Reparse(const Program &previous, const TokenBuffer &tokens,
+                  const TokenEdit &edit);
+
+  /**
+   * @brief Convert the tokens pulled from a TokenSource to List of AST nodes (Statement and Expression), lexing only as far as parsing got.
+   * @param source the TokenSource the tokens are pulled from, up to and including TokenType::EOL
+   * @return Program the list of AST (Statements and Expressions)
+   */
+  Program ProduceAST(TokenSource &source);
+
+  /**
+   * @brief Convert a list of standalone Tokens to AST nodes, the tokens are
+   * laid out in a TokenBuffer first
+   * @param tok_list the Tokens to be converted to list of AST nodes (Statement
+   * and Expression)
+   * @return Program the list of AST (Statements and Expressions)
+   */
+  Program ProduceAST(std::span<const TokenPtr> tok_list);
 
   /**
    * @brief Convert the List of Tokens to List of AST nodes(Statement and Expression).
    * @param tokenQueue the Token queue to be converted to list of AST nodes (Statement and Expression)
    * @return Program the list of AST (Statements and Expressions)
    */
-  Program ProduceAST(std::queue<TokenPtr> &tokenQueue);
+  Program ProduceAST(const std::queue<TokenPtr> &tokenQueue);
 };
 
 /**
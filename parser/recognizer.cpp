@@ -0,0 +1,176 @@
+#include "recognizer.hpp"
+
+#include <sstream>
+#include <utility>
+
+#include "grammar.hpp"
+#include "scan.hpp"
+
+Recognizer::Recognizer(std::string_view source)
+    : source_(source),
+      operators_(&OperatorRegistry::Builtin()),
+      lexer_(source.data(), source.size()),
+      scan_start_(0),
+      depth_(0) {
+  // Strings are only validated, so no lexeme owns memory
+  lexer_.SetKeepWhitespace(false);
+  lexer_.SetDecodeStrings(false);
+}
+
+void Recognizer::SetOperators(const OperatorRegistry &operators) {
+  operators_ = &operators;
+  lexer_.SetOperators(operators);
+}
+
+void Recognizer::Advance() {
+  scan_start_ = lexer_.Position();
+  next_ = lexer_.Scan();
+}
+
+SyntaxCheckResult Recognizer::Fail(std::string error) const {
+  std::stringstream error_msg;
+  error_msg << error << ", got ";
+  if (next_.tok_type == TokenType::EOL) {
+    error_msg << "the end of the input";
+  } else {
+    error_msg << "\'" << source_.substr(next_.offset, next_.length) << "\'";
+  }
+  error_msg << " at " << LineTable(source_).Locate(next_.offset);
+  return SyntaxCheckResult{false, next_.offset, error_msg.str()};
+}
+
+SyntaxCheckResult Recognizer::Check() {
+  lexer_.Seek(0);
+  depth_ = 0;
+
+  try {
+    Advance();
+    return Run();
+  } catch (WrongLexingException &e) {
+    // Report the start of the token which failed to lex
+    return SyntaxCheckResult{false, SkipWhitespace(source_, scan_start_),
+                             e.what()};
+  }
+}
+
+SyntaxCheckResult Recognizer::Run() {
+  // The rule to recognize next, COMPLETE when a Primary or Expression just
+  // ended and the state on top of the stack resumes
+  enum class Goal { STATEMENT, EXPRESSION, PRIMARY, COMPLETE };
+  Goal goal = Goal::STATEMENT;
+  // Whether the rule which just completed is a lone identifier (possibly in
+  // parentheses), the only thing "set" and "=" accept
+  bool identifier = false;
+
+  while (true) {
+    // A step pushes at most 2 states
+    if (depth_ + 2 > kMaxDepth)
+      return Fail("Expression nested too deeply for the syntax check");
+
+    OperatorType op_type = next_.op_type;
+
+    switch (goal) {
+      case Goal::STATEMENT:
+        if (next_.tok_type == TokenType::EOL)
+          return SyntaxCheckResult{true, 0, std::string()};
+
+        if (next_.tok_type == TokenType::SET) {
+          Advance();
+          Push(Resume::DECLARED_NAME);
+          goal = Goal::PRIMARY;
+        } else {
+          Push(Resume::STATEMENT_END);
+          goal = Goal::EXPRESSION;
+        }
+        break;
+
+      case Goal::EXPRESSION:
+        Push(Resume::INFIX_LOOP, 0);
+        goal = Goal::PRIMARY;
+        break;
+
+      case Goal::PRIMARY:
+        if (IsAtom(next_.tok_type)) {
+          identifier = next_.tok_type == TokenType::IDENTIFIER;
+          Advance();
+          goal = Goal::COMPLETE;
+        } else if (op_type == OperatorType::L_PARENTHESIS) {
+          Advance();
+          Push(Resume::CLOSE_PARENTHESIS);
+          goal = Goal::EXPRESSION;
+        } else if (IsAdditionOperator(op_type)) {
+          while (IsAdditionOperator(next_.op_type)) Advance();
+          if (next_.tok_type != TokenType::NUMBER)
+            return Fail("Expected a number after its sign");
+          Advance();
+          identifier = false;
+          goal = Goal::COMPLETE;
+        } else if (op_type == OperatorType::NOT) {
+          Advance();
+          Push(Resume::NOT_OPERAND);
+          Push(Resume::INFIX_LOOP,
+               operators_->Find(OperatorType::NOT)->precedence);
+          goal = Goal::PRIMARY;
+        } else {
+          return Fail("Expected an expression");
+        }
+        break;
+
+      case Goal::COMPLETE: {
+        const Frame frame = stack_[--depth_];
+        switch (frame.resume) {
+          case Resume::STATEMENT_END:
+            goal = Goal::STATEMENT;
+            break;
+
+          case Resume::DECLARED_NAME:
+            if (!identifier) return Fail("Expected an identifier");
+            if (next_.tok_type == TokenType::EOL) {
+              goal = Goal::STATEMENT;
+              break;
+            }
+            if (op_type != OperatorType::ASSIGN) return Fail("Expected \'=\'");
+            Advance();
+            Push(Resume::STATEMENT_END);
+            goal = Goal::EXPRESSION;
+            break;
+
+          case Resume::NOT_OPERAND:
+            identifier = false;
+            break;
+
+          case Resume::INFIX_OPERAND:
+            identifier = false;
+            [[fallthrough]];
+          case Resume::INFIX_LOOP: {
+            // Precedence climbing, as Parser::ParseExpression: the right
+            // operand is a Primary followed by the operators binding
+            // tighter, then the loop goes on at the same precedence
+            if (next_.tok_type != TokenType::OPERATOR) break;
+            const OperatorInfo *info = operators_->Find(op_type);
+            if (info == nullptr || !info->infix ||
+                info->precedence < frame.min_precedence)
+              break;
+            if (op_type == OperatorType::ASSIGN && !identifier)
+              return Fail("Expected an identifier");
+            Advance();
+            Push(Resume::INFIX_OPERAND, frame.min_precedence);
+            Push(Resume::INFIX_LOOP,
+                 info->associativity == Associativity::LEFT
+                     ? info->precedence + 1
+                     : info->precedence);
+            goal = Goal::PRIMARY;
+            break;
+          }
+
+          case Resume::CLOSE_PARENTHESIS:
+            if (op_type != OperatorType::R_PARENTHESIS)
+              return Fail("Expected \')\'");
+            Advance();
+            break;
+        }
+        break;
+      }
+    }
+  }
+}
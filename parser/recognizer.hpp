@@ -0,0 +1,129 @@
+/**
+ * @file recognizer.hpp
+ * @brief Contains the Recognizer class, which checks that a script follows
+ * the grammar of the Parser (see grammar.hpp) without building tokens or AST
+ * nodes
+ */
+#ifndef RECOGNIZER_H
+#define RECOGNIZER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "lexer.hpp"
+
+/**
+ * @brief Result of a syntax check
+ */
+struct SyntaxCheckResult {
+  bool valid;
+  // Byte offset of the token (or character) the first error was found at
+  std::size_t error_offset;
+  // Description of the first error, empty if the script is valid
+  std::string error;
+};
+
+/**
+ * @brief Validate-only parser. The grammar is walked by a pushdown automaton
+ * whose stack is a fixed size array, and the lexemes are scanned one at a
+ * time without decoding strings, so checking a valid script allocates
+ * nothing. A script is valid exactly when Parser::ProduceAST accepts it (up
+ * to the nesting limit).
+ */
+class Recognizer {
+ public:
+  /**
+   * @brief Number of pending grammar states the Recognizer can hold, each
+   * parenthesis or "!" nests two of them
+   */
+  static constexpr std::size_t kMaxDepth = 1024;
+
+ private:
+  /**
+   * @brief Where to resume once the Primary or Expression being recognized
+   * is complete (the return addresses of the Parser's recursive calls)
+   */
+  enum class Resume : std::uint8_t {
+    STATEMENT_END,
+    DECLARED_NAME,
+    INFIX_LOOP,
+    INFIX_OPERAND,
+    CLOSE_PARENTHESIS,
+    NOT_OPERAND,
+  };
+
+  /**
+   * @brief A pending state, with the lowest precedence of the infix operators
+   * it takes (for the INFIX_ states)
+   */
+  struct Frame {
+    Resume resume;
+    std::uint8_t min_precedence;
+  };
+
+  std::string_view source_;
+  const OperatorRegistry *operators_;
+  Lexer lexer_;
+  Lexeme next_;
+  // Where the lexer was before scanning next_ (whitespace included)
+  std::size_t scan_start_;
+  std::array<Frame, kMaxDepth> stack_;
+  std::size_t depth_;
+
+  /**
+   * @brief Scan the next lexeme into next_
+   */
+  void Advance();
+
+  /**
+   * @brief Save the state to resume from once the current rule completes
+   * (Run() keeps room for the pushes of one step)
+   * @param resume the state to resume from
+   * @param min_precedence the lowest precedence of the infix operators the
+   * state takes
+   */
+  void Push(Resume resume, int min_precedence = 0) {
+    stack_[depth_++] = Frame{resume, static_cast<std::uint8_t>(min_precedence)};
+  }
+
+  /**
+   * @brief Build the result for an error at the next lexeme
+   * @param error the description of the error
+   * @return SyntaxCheckResult the failed result
+   */
+  SyntaxCheckResult Fail(std::string error) const;
+
+  /**
+   * @brief Run the automaton over the lexemes
+   * @return SyntaxCheckResult the result of the check
+   */
+  SyntaxCheckResult Run();
+
+ public:
+  /**
+   * @brief Construct a Recognizer over a script
+   * @pre The script must outlive the Recognizer
+   * @param source the script to check
+   */
+  explicit Recognizer(std::string_view source);
+
+  /**
+   * @brief Choose the operators of the language (by default
+   * OperatorRegistry::Builtin()), as Parser::SetOperators
+   * @pre The registry must outlive the Recognizer
+   * @param operators the registry of the operators
+   */
+  void SetOperators(const OperatorRegistry &operators);
+
+  /**
+   * @brief Check the syntax of the script
+   * @return SyntaxCheckResult whether the script is valid, and where and why
+   * it is not
+   */
+  SyntaxCheckResult Check();
+};
+
+#endif
@@ -3,6 +3,8 @@
 #include <memory>
 #include <sstream>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 Environment::Environment() {
   var_map_ = std::unordered_map<std::string, RuntimeValuePtr>();
@@ -61,9 +63,79 @@ std::string Evaluater::EvaluateProgram(Program instructions) {
   return lasteval->Value();
 }
 
+std::string Evaluater::EvaluateProgram(const FlatAst &program) {
+  // Nodes are in post-order: each one pops the values of its children and
+  // pushes its own
+  std::vector<RuntimeValuePtr> values;
+  RuntimeValuePtr lasteval;
+  const std::vector<std::uint32_t> &statements = program.Statements();
+  std::size_t next_statement = 0;
+
+  for (std::uint32_t i = 0; i < program.Size(); i++) {
+    switch (program.Kind(i)) {
+      case NodeType::NullExpr:
+        values.push_back(std::make_shared<NullValue>());
+        break;
+      case NodeType::NumberExpr:
+        values.push_back(std::make_shared<NumberValue>(program.Number(i)));
+        break;
+      case NodeType::StringExpr:
+        values.push_back(
+            std::make_shared<StringValue>(std::string(program.Text(i))));
+        break;
+      case NodeType::BooleanExpr:
+        values.push_back(
+            std::make_shared<BooleanValue>(std::string(program.Text(i))));
+        break;
+      case NodeType::IdentifierExpr:
+        values.push_back(env_.GetRuntimeValue(std::string(program.Text(i))));
+        break;
+      case NodeType::NotExpr:
+        values.back() = EvaluateNotValue(values.back());
+        break;
+      case NodeType::BinaryExpr:
+      case NodeType::ComparisonExpr: {
+        RuntimeValuePtr rhs = std::move(values.back());
+        values.pop_back();
+        values.back() =
+            program.Kind(i) == NodeType::BinaryExpr
+                ? EvaluateBinaryValues(values.back(), rhs, program.Text(i))
+                : EvaluateComparisonValues(values.back(), rhs,
+                                           program.Text(i));
+        break;
+      }
+      case NodeType::VariableDeclarationStmt:
+        env_.DefineVariable(std::string(program.Text(i)), values.back());
+        break;
+      case NodeType::VariableAssignExpr:
+        env_.AssignVariable(std::string(program.Text(i)), values.back());
+        break;
+      default: {
+        std::stringstream ss_invalid_stmt_msg;
+        ss_invalid_stmt_msg
+            << "Unimplemented Statement(Expression) in Evaluate Expression : "
+            << NodeEnumToString(program.Kind(i));
+        throw UnexpectedStatementException(ss_invalid_stmt_msg.str());
+      }
+    }
+
+    // The value of a statement is only kept if it is the last one
+    if (next_statement < statements.size() &&
+        statements[next_statement] == i) {
+      lasteval = std::move(values.back());
+      values.pop_back();
+      next_statement++;
+    }
+  }
+
+  return lasteval->Value();
+}
+
 RuntimeValuePtr Evaluater::EvaluateNotExpression(NotExpression not_expr) {
-  RuntimeValuePtr expr = Evaluate(not_expr.expr_);
+  return EvaluateNotValue(Evaluate(not_expr.expr_));
+}
 
+RuntimeValuePtr Evaluater::EvaluateNotValue(RuntimeValuePtr expr) {
   if (expr->Type() == ValueType::BOOLEAN) {
     std::shared_ptr<BooleanValue> bool_expr =
         std::dynamic_pointer_cast<BooleanValue>(expr);
@@ -76,7 +148,8 @@ RuntimeValuePtr Evaluater::EvaluateNotExpression(NotExpression not_expr) {
     std::shared_ptr<NumberValue> num_expr =
         std::dynamic_pointer_cast<NumberValue>(expr);
 
-    if (stoi(num_expr->Value()) > 0) {
+    // Truncated like an integer, so 0.5 is false
+    if (static_cast<long long>(num_expr->Number()) > 0) {
       return std::make_unique<BooleanValue>("false");
     }
     return std::make_unique<BooleanValue>("true");
@@ -86,16 +159,20 @@ RuntimeValuePtr Evaluater::EvaluateNotExpression(NotExpression not_expr) {
 
 RuntimeValuePtr Evaluater::EvaluateBinaryExpression(
     BinaryExpression binary_expr) {
-  RuntimeValuePtr lhs = Evaluate(binary_expr.left_);
-  RuntimeValuePtr rhs = Evaluate(binary_expr.right_);
+  return EvaluateBinaryValues(Evaluate(binary_expr.left_),
+                              Evaluate(binary_expr.right_), binary_expr.op_);
+}
 
+RuntimeValuePtr Evaluater::EvaluateBinaryValues(RuntimeValuePtr lhs,
+                                                RuntimeValuePtr rhs,
+                                                std::string_view op) {
   if (lhs->Type() == ValueType::NUMBER && rhs->Type() == ValueType::NUMBER) {
     std::shared_ptr<NumberValue> lhs_number =
         std::dynamic_pointer_cast<NumberValue>(lhs);
     std::shared_ptr<NumberValue> rhs_number =
         std::dynamic_pointer_cast<NumberValue>(rhs);
-    NumberValue result = EvaluateNumericBinaryExpression(
-        *lhs_number, *rhs_number, binary_expr.op_);
+    NumberValue result =
+        EvaluateNumericBinaryExpression(*lhs_number, *rhs_number, op);
     return std::make_unique<NumberValue>(result);
   }
   if ((lhs->Type() == ValueType::BOOLEAN || lhs->Type() == ValueType::NUMBER) &&
@@ -108,7 +185,7 @@ RuntimeValuePtr Evaluater::EvaluateBinaryExpression(
       else
         lhs_number = std::make_shared<NumberValue>(0);
     } else {
-      std::dynamic_pointer_cast<NumberValue>(lhs);
+      lhs_number = std::dynamic_pointer_cast<NumberValue>(lhs);
     }
 
     if (rhs->Type() == ValueType::BOOLEAN) {
@@ -120,8 +197,8 @@ RuntimeValuePtr Evaluater::EvaluateBinaryExpression(
       rhs_number = std::dynamic_pointer_cast<NumberValue>(rhs);
     }
 
-    NumberValue result = EvaluateNumericBinaryExpression(
-        *lhs_number, *rhs_number, binary_expr.op_);
+    NumberValue result =
+        EvaluateNumericBinaryExpression(*lhs_number, *rhs_number, op);
     return std::make_unique<NumberValue>(result);
   }
 
@@ -130,10 +207,10 @@ RuntimeValuePtr Evaluater::EvaluateBinaryExpression(
 
 NumberValue Evaluater::EvaluateNumericBinaryExpression(NumberValue lhs,
                                                        NumberValue rhs,
-                                                       std::string op) {
+                                                       std::string_view op) {
   double result = 0;
-  double lhs_val = std::stod(lhs.Value());
-  double rhs_val = std::stod(rhs.Value());
+  double lhs_val = lhs.Number();
+  double rhs_val = rhs.Number();
 
   if (op == "+") {
     result = lhs_val + rhs_val;
@@ -156,8 +233,8 @@ RuntimeValuePtr Evaluater::Evaluate(StatementPtr curr_stmt) {
       matchValue = std::make_unique<NullValue>();
       break;
     case NodeType::NumberExpr: {
-      std::shared_ptr<NumberExpression> int_expr =
-          std::dynamic_pointer_cast<NumberExpression>(curr_stmt);
+      NumberExpression *int_expr =
+          dynamic_cast<NumberExpression *>(curr_stmt);
       if (!int_expr) {
         ss_invalid_stmt_msg
             << "Failed to cast StatementPtr to IntegerExpressionPtr : "
@@ -168,20 +245,21 @@ RuntimeValuePtr Evaluater::Evaluate(StatementPtr curr_stmt) {
       break;
     }
     case NodeType::StringExpr: {
-      std::shared_ptr<StringExpression> string_expr =
-          std::dynamic_pointer_cast<StringExpression>(curr_stmt);
+      StringExpression *string_expr =
+          dynamic_cast<StringExpression *>(curr_stmt);
       if (!string_expr) {
         ss_invalid_stmt_msg
             << "Failed to cast StatementPtr to StringExpressionPtr : "
             << curr_stmt;
         throw UnexpectedStatementException(ss_invalid_stmt_msg.str());
       }
-      matchValue = std::make_unique<StringValue>(string_expr->tok_value_);
+      matchValue =
+          std::make_unique<StringValue>(std::string(string_expr->tok_value_));
       break;
     }
     case NodeType::NotExpr: {
-      std::shared_ptr<NotExpression> not_expr =
-          std::dynamic_pointer_cast<NotExpression>(curr_stmt);
+      NotExpression *not_expr =
+          dynamic_cast<NotExpression *>(curr_stmt);
       if (!not_expr) {
         ss_invalid_stmt_msg
             << "Failed to cast StatementPtr to NotExpressionPtr : "
@@ -192,8 +270,8 @@ RuntimeValuePtr Evaluater::Evaluate(StatementPtr curr_stmt) {
       break;
     }
     case NodeType::BinaryExpr: {
-      std::shared_ptr<BinaryExpression> binary_expr =
-          std::dynamic_pointer_cast<BinaryExpression>(curr_stmt);
+      BinaryExpression *binary_expr =
+          dynamic_cast<BinaryExpression *>(curr_stmt);
       if (!binary_expr) {
         ss_invalid_stmt_msg
             << "Failed to cast StatementPtr to BinaryExpressionPtr : "
@@ -204,20 +282,21 @@ RuntimeValuePtr Evaluater::Evaluate(StatementPtr curr_stmt) {
       break;
     }
     case NodeType::IdentifierExpr: {
-      std::shared_ptr<IdentifierExpression> identifier_expr =
-          std::dynamic_pointer_cast<IdentifierExpression>(curr_stmt);
+      IdentifierExpression *identifier_expr =
+          dynamic_cast<IdentifierExpression *>(curr_stmt);
       if (!identifier_expr) {
         ss_invalid_stmt_msg
             << "Failed to cast StatementPtr to IdentifierExpressionPtr : "
             << curr_stmt;
         throw UnexpectedStatementException(ss_invalid_stmt_msg.str());
       }
-      matchValue = env_.GetRuntimeValue(identifier_expr->identifier_);
+      matchValue =
+          env_.GetRuntimeValue(std::string(identifier_expr->identifier_));
       break;
     }
     case NodeType::VariableDeclarationStmt: {
-      std::shared_ptr<VariableDeclarationStatement> var_decl_stmt =
-          std::dynamic_pointer_cast<VariableDeclarationStatement>(curr_stmt);
+      VariableDeclarationStatement *var_decl_stmt =
+          dynamic_cast<VariableDeclarationStatement *>(curr_stmt);
       if (!var_decl_stmt) {
         ss_invalid_stmt_msg << "Failed to cast StatementPtr to "
                                "VariableDeclarationStatementPtr : "
@@ -228,8 +307,8 @@ RuntimeValuePtr Evaluater::Evaluate(StatementPtr curr_stmt) {
       break;
     }
     case NodeType::VariableAssignExpr: {
-      std::shared_ptr<VariableAssignExpression> var_decl_expr =
-          std::dynamic_pointer_cast<VariableAssignExpression>(curr_stmt);
+      VariableAssignExpression *var_decl_expr =
+          dynamic_cast<VariableAssignExpression *>(curr_stmt);
       if (!var_decl_expr) {
         ss_invalid_stmt_msg << "Failed to cast StatementPtr to "
                                "VariableAssignExpressionPtr : "
@@ -240,8 +319,8 @@ RuntimeValuePtr Evaluater::Evaluate(StatementPtr curr_stmt) {
       break;
     }
     case NodeType::ComparisonExpr: {
-      std::shared_ptr<ComparisonExpression> compare_expr =
-          std::dynamic_pointer_cast<ComparisonExpression>(curr_stmt);
+      ComparisonExpression *compare_expr =
+          dynamic_cast<ComparisonExpression *>(curr_stmt);
       if (!compare_expr) {
         ss_invalid_stmt_msg << "Failed to cast StatementPtr to "
                                "ComparisonExpression : "
@@ -252,15 +331,16 @@ RuntimeValuePtr Evaluater::Evaluate(StatementPtr curr_stmt) {
       break;
     }
     case NodeType::BooleanExpr: {
-      std::shared_ptr<BooleanExpression> bool_expr =
-          std::dynamic_pointer_cast<BooleanExpression>(curr_stmt);
+      BooleanExpression *bool_expr =
+          dynamic_cast<BooleanExpression *>(curr_stmt);
       if (!bool_expr) {
         ss_invalid_stmt_msg
             << "Failed to cast StatementPtr to BooleanExpression : "
             << curr_stmt;
         throw UnexpectedStatementException(ss_invalid_stmt_msg.str());
       }
-      matchValue = std::make_unique<BooleanValue>(bool_expr->boolean_);
+      matchValue =
+          std::make_unique<BooleanValue>(std::string(bool_expr->boolean_));
       break;
     }
     default:
@@ -276,7 +356,8 @@ RuntimeValuePtr Evaluater::Evaluate(StatementPtr curr_stmt) {
 RuntimeValuePtr Evaluater::EvaluateDefiningIdentifierExpression(
     VariableDeclarationStatement var_decl_stmt) {
   RuntimeValuePtr evalAssignedVal = Evaluate(var_decl_stmt.value_);
-  env_.DefineVariable(var_decl_stmt.identifier_, evalAssignedVal);
+  env_.DefineVariable(std::string(var_decl_stmt.identifier_),
+                      evalAssignedVal);
 
   return evalAssignedVal;
 }
@@ -284,17 +365,22 @@ RuntimeValuePtr Evaluater::EvaluateDefiningIdentifierExpression(
 RuntimeValuePtr Evaluater::EvaluateAssignIdentifierExpression(
     VariableAssignExpression var_assign_expr) {
   RuntimeValuePtr eval_assigned_val = Evaluate(var_assign_expr.Value);
-  env_.AssignVariable(var_assign_expr.Name, eval_assigned_val);
+  env_.AssignVariable(std::string(var_assign_expr.Name), eval_assigned_val);
 
   return eval_assigned_val;
 }
 
 RuntimeValuePtr Evaluater::EvaluateComparisonExpression(
     ComparisonExpression compare_expr) {
-  RuntimeValuePtr lhs = Evaluate(compare_expr.left_);
-  RuntimeValuePtr rhs = Evaluate(compare_expr.right_);
+  return EvaluateComparisonValues(Evaluate(compare_expr.left_),
+                                  Evaluate(compare_expr.right_),
+                                  compare_expr.op_);
+}
 
-  bool is_equal_op = compare_expr.op_ == "==" ? true : false;
+RuntimeValuePtr Evaluater::EvaluateComparisonValues(RuntimeValuePtr lhs,
+                                                    RuntimeValuePtr rhs,
+                                                    std::string_view op) {
+  bool is_equal_op = op == "==" ? true : false;
 
   // Compare value of equal type
   if (lhs->Type() == rhs->Type()) {
@@ -315,7 +401,10 @@ RuntimeValuePtr Evaluater::EvaluateComparisonExpression(
       lhs = rhs;
       rhs = temp;
     }
-    std::string num_to_bool = std::stoi(lhs->Value()) > 0 ? "true" : "false";
+    std::shared_ptr<NumberValue> lhs_number =
+        std::dynamic_pointer_cast<NumberValue>(lhs);
+    std::string num_to_bool =
+        static_cast<long long>(lhs_number->Number()) > 0 ? "true" : "false";
     bool is_equal_val = num_to_bool == rhs->Value();
     std::string eval_boolean_str = is_equal_val ? "true" : "false";
     if (!is_equal_op) {
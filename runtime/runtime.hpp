@@ -10,9 +10,11 @@
 #include <memory>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 #include "ast.hpp"
+#include "flat_ast.hpp"
 
 /**
  * @brief The ValueType enum class for RuntimeValue Type Identifications
@@ -93,6 +95,13 @@ class NumberValue : public RuntimeValue {
    */
   std::string Value() const { return MaxDecimalNumberInStr(); }
 
+  /**
+   * @brief Number returns the number itself, without going through its string
+   * representation
+   * @return double The number
+   */
+  double Number() const { return number_; }
+
  private:
   // Return the number until the longest decimal point available
   /**
@@ -234,6 +243,13 @@ class Evaluater {
    * @return RuntimeValuePtr return the opposite value of the expression
    */
   RuntimeValuePtr EvaluateNotExpression(NotExpression not_expr);
+  /**
+   * @brief EvaluateNotValue Converts an evaluated operand of a NotExpression
+   * to the opposite value
+   * @param expr The evaluated operand
+   * @return RuntimeValuePtr The opposite value of the operand (Boolean/Null)
+   */
+  RuntimeValuePtr EvaluateNotValue(RuntimeValuePtr expr);
   /**
    * @brief EvaluateBinaryExpression Evaluates the BinaryExpression and
    * Add/Subtract/Multiply/Divide the two expressions
@@ -242,6 +258,17 @@ class Evaluater {
    * Boolean/Number/Null format
    */
   RuntimeValuePtr EvaluateBinaryExpression(BinaryExpression bin_expr);
+  /**
+   * @brief EvaluateBinaryValues Applies the operator of a BinaryExpression to
+   * its evaluated operands
+   * @param lhs The evaluated left hand side
+   * @param rhs The evaluated right hand side
+   * @param op The operator to apply to the two values
+   * @return RuntimeValuePtr The result in Number/Null format
+   */
+  RuntimeValuePtr EvaluateBinaryValues(RuntimeValuePtr lhs,
+                                       RuntimeValuePtr rhs,
+                                       std::string_view op);
   /**
    * @brief EvaluateNumericBinaryExpression Evaluates the BinaryExpression and
    * Add/Subtract/Multiply/Divide the two expressions
@@ -251,7 +278,7 @@ class Evaluater {
    * @return NumberValue The result of the BinaryExpression in Number format
    */
   NumberValue EvaluateNumericBinaryExpression(NumberValue lhs, NumberValue rhs,
-                                              std::string op);
+                                              std::string_view op);
   /**
    * @brief EvaluateDefiningIdentifierExpression Evaluates the
    * VariableDeclarationStatement and defines the variable in the environment
@@ -280,6 +307,17 @@ class Evaluater {
    */
   RuntimeValuePtr EvaluateComparisonExpression(
       ComparisonExpression compareExpr);
+  /**
+   * @brief EvaluateComparisonValues Compares the evaluated operands of a
+   * ComparisonExpression
+   * @param lhs The evaluated left hand side
+   * @param rhs The evaluated right hand side
+   * @param op The comparison operator (== or !=)
+   * @return RuntimeValuePtr Whether the value is same or not (In boolean)
+   */
+  RuntimeValuePtr EvaluateComparisonValues(RuntimeValuePtr lhs,
+                                           RuntimeValuePtr rhs,
+                                           std::string_view op);
   RuntimeValuePtr Evaluate(StatementPtr currStmt);
 
  public:
@@ -294,6 +332,14 @@ class Evaluater {
    * @return std::string The result of the program in string format
    */
   std::string EvaluateProgram(Program instructions);
+
+  /**
+   * @brief EvaluateProgram Evaluates a flattened program with a single forward
+   * walk over its nodes, the same way as the Program it was flattened from
+   * @param program The FlatAst to evaluate
+   * @return std::string The result of the program in string format
+   */
+  std::string EvaluateProgram(const FlatAst &program);
 };
 
 /**
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+#include "ast.hpp"
+#include "ast_arena.hpp"
+#include "flat_ast.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+
+TEST(AstArenaTest, Allocate) {
+  AstArena arena;
+
+  // 1 : Nodes are aligned and do not overlap
+  NumberExpression *first = arena.New<NumberExpression>(1);
+  char *byte = static_cast<char *>(arena.Allocate(1, 1));
+  NumberExpression *second = arena.New<NumberExpression>(2);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(second) %
+                alignof(NumberExpression),
+            0);
+  EXPECT_LT(reinterpret_cast<char *>(first), byte);
+  EXPECT_LT(byte, reinterpret_cast<char *>(second));
+  EXPECT_EQ(first->tok_value_, 1);
+  EXPECT_EQ(second->tok_value_, 2);
+
+  // 2 : Past the inline block, and larger than a block
+  for (int i = 0; i < 1000; i++) arena.New<NullExpression>();
+  void *large = arena.Allocate(AstArena::kMaxBlockSize * 2, 8);
+  EXPECT_NE(large, nullptr);
+  EXPECT_EQ(arena.New<NumberExpression>(3)->tok_value_, 3);
+
+  // 3
+  std::string text = "identifier";
+  std::string_view copy = arena.CopyText(text);
+  text[0] = 'x';
+  EXPECT_EQ(copy, "identifier");
+  EXPECT_TRUE(arena.CopyText("").empty());
+}
+
+TEST(AstArenaTest, ProgramOwnsItsNodes) {
+  Program copy;
+  {
+    std::string input = "set name = \"text\" + 1\nname = name == 2";
+    Lexer lexer = Lexer(input);
+    Program program = Parser().ProduceAST(lexer.Tokenize());
+    EXPECT_GT(program.Arena().BytesUsed(), 0);
+    copy = program;
+  }
+
+  // 1 : The copy keeps the nodes (and their text) alive after the source, the
+  // tokens and the original Program are gone
+  ASSERT_EQ(copy.body_.size(), 2);
+  StatementPtr declaration = copy.body_.front();
+  ASSERT_EQ(declaration->Type(), NodeType::VariableDeclarationStmt);
+  auto *var_decl = static_cast<VariableDeclarationStatement *>(declaration);
+  EXPECT_EQ(var_decl->identifier_, "name");
+  StatementPtr assignment = copy.body_.back();
+  ASSERT_EQ(assignment->Type(), NodeType::VariableAssignExpr);
+  EXPECT_EQ(static_cast<VariableAssignExpression *>(assignment)->Name, "name");
+}
+
+TEST(FlatAstTest, MatchesProgram) {
+  std::string scripts[] = {
+      "1 + 2 * (3 - 4)",
+      "set name = \"text\" + 1\nname = name == !true",
+      "-2.5 != null\nset empty",
+  };
+
+  for (const std::string &script : scripts) {
+    Lexer lexer = Lexer(script);
+    Program program = Parser().ProduceAST(lexer.Tokenize());
+    FlatAst flat_ast = FlatAst(program);
+
+    // 1 : Prints the same as the Program it was flattened from
+    std::stringstream program_out;
+    std::stringstream flat_out;
+    program_out << program;
+    flat_out << flat_ast;
+    EXPECT_EQ(flat_out.str(), program_out.str());
+
+    // 2 : Children come before their parent, statements are in order
+    ASSERT_EQ(flat_ast.Statements().size(), program.body_.size());
+    for (std::size_t i = 0; i < flat_ast.Size(); i++) {
+      const FlatNode &node = flat_ast.Node(i);
+      if (node.first != FlatAst::kNoNode) {
+        EXPECT_LT(node.first, i);
+      }
+      if (node.second != FlatAst::kNoNode) {
+        EXPECT_LT(node.second, i);
+      }
+    }
+    EXPECT_EQ(flat_ast.Statements().back(), flat_ast.Size() - 1);
+  }
+
+  // 3
+  Lexer lexer = Lexer("set x = 12\nx");
+  FlatAst flat_ast = FlatAst(Parser().ProduceAST(lexer.Tokenize()));
+  ASSERT_EQ(flat_ast.Size(), 3);
+  EXPECT_EQ(flat_ast.Kind(0), NodeType::NumberExpr);
+  EXPECT_EQ(flat_ast.Number(0), 12);
+  EXPECT_EQ(flat_ast.Kind(1), NodeType::VariableDeclarationStmt);
+  EXPECT_EQ(flat_ast.Node(1).first, 0);
+  EXPECT_EQ(flat_ast.Text(1), "x");
+  EXPECT_EQ(flat_ast.Kind(2), NodeType::IdentifierExpr);
+  EXPECT_EQ(flat_ast.Text(2), "x");
+  EXPECT_GT(flat_ast.MemoryUsage(), 0);
+}
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include "file.hpp"
+#include "lexer.hpp"
+#include "token_buffer.hpp"
+
+namespace {
+
+// Write the script to a new temporary file and return its name
+std::string WriteScriptFile(const std::string &script) {
+  char filename[] = "/tmp/aparser_test_XXXXXX";
+  int fd = mkstemp(filename);
+  EXPECT_GE(fd, 0);
+  EXPECT_EQ(write(fd, script.data(), script.size()),
+            static_cast<ssize_t>(script.size()));
+  close(fd);
+  return filename;
+}
+
+}  // namespace
+
+TEST(FileTest, MappedRegularFile) {
+  std::string filename = WriteScriptFile("set hello = 1\nhello");
+  File test1 = File(filename);
+
+  // 1
+  EXPECT_TRUE(test1.IsMapped());
+  EXPECT_EQ(test1.View(), "set hello = 1\nhello");
+  EXPECT_EQ(test1.Read(), "set hello = 1\nhello");
+
+  std::remove(filename.c_str());
+}
+
+TEST(FileTest, PipeFallback) {
+  int pipe_fds[2];
+  ASSERT_EQ(pipe(pipe_fds), 0);
+  ASSERT_EQ(write(pipe_fds[1], "1 + 2", 5), 5);
+  close(pipe_fds[1]);
+
+  File test1 = File("/dev/fd/" + std::to_string(pipe_fds[0]));
+  close(pipe_fds[0]);
+
+  // 1
+  EXPECT_FALSE(test1.IsMapped());
+  EXPECT_EQ(test1.View(), "1 + 2");
+}
+
+TEST(FileTest, LexFile) {
+  std::string filename = WriteScriptFile("\"abc\" + x");
+  TokenBuffer tokens = Lexer(std::make_shared<File>(filename)).Tokenize();
+
+  // 1 : The tokens keep the mapped file alive after the Lexer is gone
+  ASSERT_EQ(tokens.Size(), 6);
+  EXPECT_EQ(tokens.Text(0), "abc");
+  EXPECT_EQ(tokens.Text(4), "x");
+
+  std::remove(filename.c_str());
+
+  // 2
+  EXPECT_THROW(File("/nonexistent/script.ap"), FileNotOpenedException);
+}
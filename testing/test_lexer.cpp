@@ -1,10 +1,14 @@
 #include <gtest/gtest.h>
 
 #include <string>
+#include <utility>
 
+#include "char_class.hpp"
 #include "lexer.hpp"
 #include "operator.hpp"
+#include "operator_registry.hpp"
 #include "token.hpp"
+#include "token_buffer.hpp"
 
 TEST(LexerTest, EmptyInput) {
   Lexer test1 = Lexer("");
@@ -309,3 +313,532 @@ TEST(LexerTest, IncompleteStringException) {
   // 1
   EXPECT_THROW(*(test2.NextToken()), WrongLexingException);
 }
+
+TEST(LexerTest, BorrowedInput) {
+  // Only "1 + x" is lexed, the rest of the buffer is out of range
+  std::string input = "1 + x    ignored";
+  Lexer test1 = Lexer(input.data(), 5);
+
+  // 1
+  EXPECT_EQ(*(test1.NextToken()),
+            *(GenerateToken("1", TokenType::NUMBER, OperatorPtr(nullptr))));
+
+  // 2
+  EXPECT_EQ(*(test1.NextToken()),
+            *(GenerateToken(" ", TokenType::WHITESPACE, OperatorPtr(nullptr))));
+
+  // 3
+  EXPECT_EQ(*(test1.NextToken()),
+            *(GenerateToken("+", TokenType::OPERATOR,
+                            GenerateOp("+", OperatorType::PLUS))));
+
+  // 4
+  EXPECT_EQ(*(test1.NextToken()),
+            *(GenerateToken(" ", TokenType::WHITESPACE, OperatorPtr(nullptr))));
+
+  // 5
+  EXPECT_EQ(*(test1.NextToken()),
+            *(GenerateToken("x", TokenType::IDENTIFIER, OperatorPtr(nullptr))));
+
+  // 6
+  EXPECT_EQ(*(test1.NextToken()),
+            *(GenerateToken("", TokenType::EOL, OperatorPtr(nullptr))));
+}
+
+TEST(LexerTest, DoubleDotNumberException) {
+  Lexer test1 = Lexer("1.2.3");
+
+  // 1
+  EXPECT_THROW(*(test1.NextToken()), WrongLexingException);
+}
+
+TEST(LexerTest, ReservedKeyword) {
+  Lexer test1 = Lexer("");
+
+  // 1 : Every keyword is found by the keyword hash
+  for (const ReservedKeyword &keyword : kReservedKeywords) {
+    EXPECT_EQ(test1.GetReservedKeywordTokenType(keyword.text),
+              keyword.tok_type);
+  }
+
+  // 2 : Identifiers sharing length, first or last letter with a keyword
+  EXPECT_EQ(test1.GetReservedKeywordTokenType("fund"), TokenType::INVALID);
+  EXPECT_EQ(test1.GetReservedKeywordTokenType("sat"), TokenType::INVALID);
+  EXPECT_EQ(test1.GetReservedKeywordTokenType("returns"), TokenType::INVALID);
+  EXPECT_EQ(test1.GetReservedKeywordTokenType("nul"), TokenType::INVALID);
+  EXPECT_EQ(test1.GetReservedKeywordTokenType("i"), TokenType::INVALID);
+  EXPECT_EQ(test1.GetReservedKeywordTokenType("True"), TokenType::INVALID);
+  EXPECT_EQ(test1.GetReservedKeywordTokenType(""), TokenType::INVALID);
+
+  // 3
+  Lexer test2 = Lexer("iff");
+  EXPECT_EQ(
+      *(test2.NextToken()),
+      *(GenerateToken("iff", TokenType::IDENTIFIER, OperatorPtr(nullptr))));
+}
+
+TEST(LexerTest, Tokenize) {
+  std::string input = "set s = \"a\\\"b\" + \"cd\"";
+  Lexer test1 = Lexer(input.data(), input.size());
+  TokenBuffer tokens = test1.Tokenize();
+
+  // 1 : Same tokens as NextToken, ending with EOL
+  Lexer test2 = Lexer(input);
+  ASSERT_EQ(tokens.Size(), 12);
+  for (std::size_t i = 0; i < tokens.Size(); i++) {
+    EXPECT_EQ(*(tokens.ToToken(i)), *(test2.NextToken()));
+  }
+
+  // 2 : Tokens refer back into the input
+  EXPECT_EQ(tokens.Text(2).data(), input.data() + 4);
+  EXPECT_EQ(tokens.Offset(11), input.size());
+
+  // 3 : String literals, with and without escapes
+  EXPECT_EQ(tokens.Text(6), "a\"b");
+  EXPECT_EQ(tokens.Text(10), "cd");
+  EXPECT_EQ(tokens.Length(10), 4);
+  EXPECT_EQ(tokens.OpType(8), OperatorType::PLUS);
+}
+
+TEST(LexerTest, OperatorMaximalMunch) {
+  Lexer test1 = Lexer("a==b!=!c=!");
+  TokenBuffer tokens = test1.Tokenize();
+
+  const OperatorType expected_ops[] = {
+      OperatorType::INVALID,   OperatorType::EQUAL, OperatorType::INVALID,
+      OperatorType::NOT_EQUAL, OperatorType::NOT,   OperatorType::INVALID,
+      OperatorType::ASSIGN,    OperatorType::NOT,   OperatorType::INVALID,
+  };
+
+  // 1
+  ASSERT_EQ(tokens.Size(), 9);
+  for (std::size_t i = 0; i < tokens.Size(); i++) {
+    EXPECT_EQ(tokens.OpType(i), expected_ops[i]) << i;
+  }
+
+  // 2 : Operator tokens share one immutable Operator per operator type
+  Lexer test2 = Lexer("++");
+  TokenPtr first = test2.NextToken();
+  TokenPtr second = test2.NextToken();
+  EXPECT_EQ(first->OpPtr(), second->OpPtr());
+  EXPECT_EQ(first->OpPtr()->Precedence(), 5);
+}
+
+TEST(LexerTest, CharClassTable) {
+  // 1 : Every operator starts with an operator byte
+  for (const OperatorInfo &info : kOperatorTable) {
+    EXPECT_EQ(ClassifyByte(info.text.front()), CharClass::OPERATOR)
+        << info.text;
+  }
+
+  // 2
+  EXPECT_EQ(StartAction('\0'), LexAction::EOL);
+  EXPECT_EQ(StartAction('\r'), LexAction::WHITESPACE);
+  EXPECT_EQ(StartAction('"'), LexAction::STRING);
+  EXPECT_EQ(StartAction('7'), LexAction::NUMBER);
+  EXPECT_EQ(StartAction('Z'), LexAction::IDENTIFIER);
+  EXPECT_EQ(StartAction('@'), LexAction::ERROR);
+  EXPECT_EQ(StartAction('\xff'), LexAction::ERROR);
+
+  // 3 : Every single byte input lexes as its start action says (a lone
+  // quote is an unterminated string, a lone UTF-8 lead byte a cut sequence)
+  for (int ch = 1; ch < 256; ch++) {
+    std::string input(1, static_cast<char>(ch));
+    Lexer lexer = Lexer(input);
+    LexAction action = StartAction(input[0]);
+    if (action == LexAction::ERROR || action == LexAction::STRING ||
+        ClassifyByte(input[0]) == CharClass::UTF8_LEAD) {
+      EXPECT_THROW(lexer.NextToken(), WrongLexingException) << ch;
+      continue;
+    }
+    TokenPtr token = lexer.NextToken();
+    EXPECT_EQ(token->Text(), input) << ch;
+    EXPECT_EQ(lexer.NextToken()->Type(), TokenType::EOL) << ch;
+  }
+}
+
+TEST(LexerTest, Relex) {
+  const std::string before = "let ab = \"x\\\"y\" + 12.5 != foo(cd) - 1e+ x";
+  const std::string inserts[] = {"", "1", "\"", " ", "=", "z9", "!", "."};
+
+  TokenBuffer previous = Lexer(before).Tokenize();
+
+  // 1 : Every edit gives the same tokens as lexing the edited source again
+  for (std::size_t offset = 0; offset <= before.size(); offset++) {
+    for (std::size_t removed = 0;
+         removed <= 3 && offset + removed <= before.size(); removed++) {
+      for (const std::string &inserted : inserts) {
+        std::string after = before;
+        after.replace(offset, removed, inserted);
+
+        TokenBuffer expected;
+        try {
+          expected = Lexer(after).Tokenize();
+        } catch (WrongLexingException &) {
+          EXPECT_THROW(
+              Lexer(after).Relex(previous, {offset, removed, inserted.size()}),
+              WrongLexingException);
+          continue;
+        }
+
+        TokenBuffer tokens =
+            Lexer(after).Relex(previous, {offset, removed, inserted.size()});
+        ASSERT_EQ(tokens.Size(), expected.Size()) << after;
+        for (std::size_t i = 0; i < tokens.Size(); i++) {
+          EXPECT_EQ(tokens.Type(i), expected.Type(i)) << after;
+          EXPECT_EQ(tokens.OpType(i), expected.OpType(i)) << after;
+          EXPECT_EQ(tokens.Offset(i), expected.Offset(i)) << after;
+          EXPECT_EQ(tokens.Length(i), expected.Length(i)) << after;
+          EXPECT_EQ(tokens.Text(i), expected.Text(i)) << after;
+        }
+      }
+    }
+  }
+
+  // 2 : Successive edits, each relexed from the previous result
+  Lexer test2 = Lexer("a+b");
+  TokenBuffer tokens = test2.Tokenize();
+  Lexer test3 = Lexer("a+bc*d");
+  tokens = test3.Relex(tokens, {3, 0, 3});
+  Lexer test4 = Lexer("ab=\"q\\\"\"+bc*d");
+  tokens = test4.Relex(tokens, {1, 0, 7});
+  ASSERT_EQ(tokens.Size(), 8);
+  EXPECT_EQ(tokens.Text(2), "q\"");
+  EXPECT_EQ(tokens.Text(4), "bc");
+  EXPECT_EQ(tokens.Offset(7), 13);
+
+  // 3 : An edit inside an exponent, which the number before it looks at
+  Lexer test5 = Lexer("1e+x");
+  tokens = test5.Tokenize();
+  Lexer test6 = Lexer("1e+5");
+  tokens = test6.Relex(tokens, {3, 1, 1});
+  ASSERT_EQ(tokens.Size(), 2);
+  EXPECT_EQ(tokens.Number(0), 1e5);
+
+  // 4 : An edit which does not fit the previous source
+  EXPECT_THROW(Lexer("abc").Relex(previous, {before.size(), 1, 0}),
+               LexLineOutOfBoundException);
+  EXPECT_THROW(Lexer("abc").Relex(previous, {0, 0, 0}),
+               LexLineOutOfBoundException);
+}
+
+TEST(LexerTest, RelexLargeInput) {
+  // Check every token, without a failure for each of them
+  auto same_tokens = [](const TokenBuffer &tokens,
+                        const TokenBuffer &expected) {
+    if (tokens.Size() != expected.Size()) return false;
+    for (std::size_t i = 0; i < tokens.Size(); i++) {
+      if (tokens.Type(i) != expected.Type(i) ||
+          tokens.Offset(i) != expected.Offset(i) ||
+          tokens.Length(i) != expected.Length(i) ||
+          tokens.Text(i) != expected.Text(i) ||
+          tokens.Number(i) != expected.Number(i)) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  for (int lines : {3000, 9000}) {
+    std::string before;
+    for (int i = 0; i < lines; i++) {
+      before += "let a" + std::to_string(i) + " = \"q\\\"" +
+                std::to_string(i) + "\" + 0x1F\n";
+    }
+    Lexer lexer = Lexer(before);
+    lexer.SetKeepWhitespace(false);
+    TokenBuffer previous = lexer.Tokenize();
+
+    // 1 : Edits at the beginning, around chunk boundaries and at the end
+    // 6 tokens per line
+    std::size_t chunk_line = TokenBuffer::kChunkSize / 6;
+    const std::size_t lines_edited[] = {0, 1, chunk_line - 1, chunk_line,
+                                        chunk_line * 3 + 5,
+                                        static_cast<std::size_t>(lines - 1)};
+    for (std::size_t line : lines_edited) {
+      std::size_t offset = 0;
+      for (std::size_t i = 0; i < line; i++)
+        offset = before.find('\n', offset) + 1;
+      std::string after = before;
+      after.replace(offset, 3, "set");
+
+      Lexer relexer = Lexer(after);
+      relexer.SetKeepWhitespace(false);
+      TokenBuffer tokens = relexer.Relex(previous, {offset, 3, 3});
+      Lexer full = Lexer(after);
+      full.SetKeepWhitespace(false);
+      EXPECT_TRUE(same_tokens(tokens, full.Tokenize())) << lines << " " << line;
+
+      // 2 : The other tokens are shared with the previous buffer, whatever
+      // the size of the input
+      EXPECT_LT(tokens.Size() - tokens.SharedWith(previous),
+                TokenBuffer::kChunkSize)
+          << lines << " " << line;
+    }
+
+    // 3 : A chain of edits, each relexed from the previous result, which
+    // moves the tokens after them
+    std::string source = before;
+    TokenBuffer tokens = previous;
+    for (std::size_t i = 0; i < 10; i++) {
+      std::size_t offset = (source.size() / 10) * i;
+      offset = source.find('\n', offset) + 1;
+      std::string inserted = i % 2 == 0 ? "1+\"x\" " : "";
+      std::size_t removed = i % 3 == 0 ? 4 : 0;
+      source.replace(offset, removed, inserted);
+
+      Lexer relexer = Lexer(source);
+      relexer.SetKeepWhitespace(false);
+      TokenBuffer relexed =
+          relexer.Relex(tokens, {offset, removed, inserted.size()});
+      Lexer full = Lexer(source);
+      full.SetKeepWhitespace(false);
+      ASSERT_TRUE(same_tokens(relexed, full.Tokenize())) << lines << " " << i;
+      EXPECT_LT(relexed.Size() - relexed.SharedWith(tokens),
+                TokenBuffer::kChunkSize)
+          << lines << " " << i;
+      tokens = std::move(relexed);
+    }
+  }
+}
+
+TEST(LexerTest, TokenizeParallel) {
+  // String literals spanning lines make chunks start inside them, with
+  // characters ('#', '"') which fail or mislead a speculative lexer
+  std::string input;
+  for (int i = 0; i < 40; i++) {
+    input += "let a" + std::to_string(i) + " = " + std::to_string(i) + ".5\n";
+    if (i % 3 == 0) input += "print(\"#\n\\\"x = \n# \\\"\n\")\n";
+  }
+  TokenBuffer expected = Lexer(input).Tokenize();
+
+  // 1 : Same tokens as Tokenize() for any split
+  for (unsigned thread_count = 1; thread_count <= 16; thread_count++) {
+    for (std::size_t min_chunk_size : {1, 7, 64}) {
+      TokenBuffer tokens =
+          Lexer(input).TokenizeParallel(thread_count, min_chunk_size);
+      ASSERT_EQ(tokens.Size(), expected.Size()) << thread_count;
+      for (std::size_t i = 0; i < tokens.Size(); i++) {
+        EXPECT_EQ(tokens.Type(i), expected.Type(i));
+        EXPECT_EQ(tokens.Offset(i), expected.Offset(i));
+        EXPECT_EQ(tokens.Length(i), expected.Length(i));
+        EXPECT_EQ(tokens.Text(i), expected.Text(i));
+      }
+    }
+  }
+
+  // 2 : Same without whitespace tokens
+  Lexer test2 = Lexer(input);
+  test2.SetKeepWhitespace(false);
+  expected = test2.Tokenize();
+  for (unsigned thread_count = 2; thread_count <= 16; thread_count *= 2) {
+    Lexer test3 = Lexer(input);
+    test3.SetKeepWhitespace(false);
+    TokenBuffer tokens = test3.TokenizeParallel(thread_count, 1);
+    ASSERT_EQ(tokens.Size(), expected.Size()) << thread_count;
+    for (std::size_t i = 0; i < tokens.Size(); i++) {
+      EXPECT_EQ(tokens.Offset(i), expected.Offset(i));
+      EXPECT_EQ(tokens.Length(i), expected.Length(i));
+    }
+  }
+
+  // 3 : A real error is still reported
+  std::string invalid = input + "a # b\n" + input;
+  EXPECT_THROW(Lexer(invalid).TokenizeParallel(8, 1), WrongLexingException);
+}
+
+TEST(LexerTest, SkipWhitespace) {
+  const std::string input = "  set a =\t\"x y\" \n+ 1  ";
+  Lexer test1 = Lexer(input);
+  test1.SetKeepWhitespace(false);
+  TokenBuffer tokens = test1.Tokenize();
+
+  const TokenType expected_types[] = {
+      TokenType::SET,    TokenType::IDENTIFIER, TokenType::OPERATOR,
+      TokenType::STRING, TokenType::OPERATOR,   TokenType::NUMBER,
+      TokenType::EOL,
+  };
+
+  // 1 : No whitespace tokens
+  ASSERT_EQ(tokens.Size(), 7);
+  for (std::size_t i = 0; i < tokens.Size(); i++) {
+    EXPECT_EQ(tokens.Type(i), expected_types[i]) << i;
+  }
+
+  // 2 : The whitespace is left in the gaps between the tokens
+  EXPECT_EQ(tokens.LeadingTrivia(0), "  ");
+  EXPECT_EQ(tokens.LeadingTrivia(2), " ");
+  EXPECT_EQ(tokens.LeadingTrivia(3), "\t");
+  EXPECT_EQ(tokens.LeadingTrivia(4), " \n");
+  EXPECT_EQ(tokens.LeadingTrivia(6), "  ");
+  EXPECT_EQ(tokens.Offset(6), input.size());
+
+  // 3 : Relexing and parallel lexing skip it too
+  Lexer test2 = Lexer("  set ab =\t\"x y\" \n+ 1  ");
+  test2.SetKeepWhitespace(false);
+  TokenBuffer relexed = test2.Relex(tokens, {6, 0, 1});
+  ASSERT_EQ(relexed.Size(), 7);
+  EXPECT_EQ(relexed.Text(1), "ab");
+  EXPECT_EQ(relexed.LeadingTrivia(4), " \n");
+
+  Lexer test3 = Lexer(input + input);
+  test3.SetKeepWhitespace(false);
+  EXPECT_EQ(test3.TokenizeParallel(4, 1).Size(), 13);
+
+  Lexer test4 = Lexer("a b");
+  test4.SetKeepWhitespace(false);
+  relexed = test4.Relex(Lexer("ab").Tokenize(), {1, 0, 1});
+  ASSERT_EQ(relexed.Size(), 3);
+  EXPECT_EQ(relexed.Text(1), "b");
+}
+
+TEST(LexerTest, NumberLiterals) {
+  const std::pair<std::string, double> literals[] = {
+      {"42", 42},         {"2.5", 2.5},          {"1.", 1},
+      {"1e9", 1e9},       {"2.5E-3", 2.5e-3},    {"7e+2", 700},
+      {"0xFF", 255},      {"0Xff_ff", 65535},    {"0b101", 5},
+      {"0B1_0000", 16},   {"1_000_000", 1e6},    {"3_1.4_1", 31.41},
+  };
+
+  for (const auto &[literal, value] : literals) {
+    Lexer test1 = Lexer(literal);
+    TokenPtr tok = test1.NextToken();
+
+    // 1 : Decoded once by the lexer
+    EXPECT_EQ(tok->Type(), TokenType::NUMBER) << literal;
+    EXPECT_EQ(tok->Text(), literal);
+    EXPECT_DOUBLE_EQ(tok->Number(), value) << literal;
+    EXPECT_EQ(test1.NextToken()->Type(), TokenType::EOL) << literal;
+
+    // 2 : Same value in a TokenBuffer
+    TokenBuffer tokens = Lexer(literal).Tokenize();
+    EXPECT_DOUBLE_EQ(tokens.Number(0), value) << literal;
+  }
+
+  // 3 : An 'e' without exponent digits starts the next token
+  Lexer test3 = Lexer("2else");
+  EXPECT_DOUBLE_EQ(test3.NextToken()->Number(), 2);
+  EXPECT_EQ(test3.NextToken()->Text(), "else");
+
+  // 4 : Malformed literals
+  const std::string invalid[] = {"0x",   "0xFG", "0b102", "1__0",
+                                 "1_",   "1_.5", "0x_1",  "1e999"};
+  for (const std::string &literal : invalid) {
+    EXPECT_THROW(Lexer(literal).NextToken(), WrongLexingException) << literal;
+  }
+
+  // 5 : Tokens built without the lexer decode their text
+  EXPECT_DOUBLE_EQ(
+      GenerateToken("0x10", TokenType::NUMBER, OperatorPtr(nullptr))->Number(),
+      16);
+}
+
+TEST(LexerTest, StringEscapes) {
+  const std::pair<std::string, std::string> literals[] = {
+      {"\"a\\nb\"", "a\nb"},
+      {"\"\\tx\\\\y\\\"\"", "\tx\\y\""},
+      {"\"\\u0041\\u00e9\\u20AC\"", "A\xC3\xA9\xE2\x82\xAC"},
+      {"\"\\uD83D\\uDE02!\"", "\xF0\x9F\x98\x82!"},
+  };
+
+  for (const auto &[literal, text] : literals) {
+    // 1
+    EXPECT_EQ(Lexer(literal).NextToken()->Text(), text) << literal;
+    EXPECT_EQ(Lexer(literal).Tokenize().Text(0), text) << literal;
+  }
+
+  // 2 : A string without escapes refers to the source
+  std::string input = "\"plain text\"";
+  TokenBuffer tokens = Lexer(input.data(), input.size()).Tokenize();
+  EXPECT_EQ(tokens.Text(0), "plain text");
+  EXPECT_EQ(tokens.Text(0).data(), input.data() + 1);
+
+  // 3 : Bad escapes
+  const std::string invalid[] = {"\"\\q\"",         "\"\\u12G4\"",
+                                 "\"\\uDE02\"",     "\"\\uD83Dx\"",
+                                 "\"\\uD83D\\u0041\"", "\"\\u12",
+                                 "\"abc\\"};
+  for (const std::string &literal : invalid) {
+    EXPECT_THROW(Lexer(literal).NextToken(), WrongLexingException) << literal;
+  }
+}
+
+TEST(LexerTest, Utf8) {
+  Lexer test1 = Lexer(
+      "set 名前 = \"été \U0001F600\"\n"
+      "élève2 + áb");
+  TokenBuffer tokens = test1.Tokenize();
+
+  // 1 : Non ASCII identifiers and strings, a combining mark continues an
+  // identifier
+  ASSERT_EQ(tokens.Size(), 14);
+  EXPECT_EQ(tokens.Type(2), TokenType::IDENTIFIER);
+  EXPECT_EQ(tokens.Text(2), "名前");
+  EXPECT_EQ(tokens.Type(6), TokenType::STRING);
+  EXPECT_EQ(tokens.Text(6), "été \U0001F600");
+  EXPECT_EQ(tokens.Text(8), "élève2");
+  EXPECT_EQ(tokens.Text(12), "áb");
+
+  // 2 : A character which is not XID_Continue ends the identifier, and
+  // can't start one either
+  Lexer test2 = Lexer("ab×");
+  EXPECT_EQ(test2.NextToken()->Text(), "ab");
+  EXPECT_THROW(test2.NextToken(), WrongLexingException);
+
+  // 3 : Invalid UTF-8 in identifiers and strings
+  const std::string invalid[] = {
+      "́a",           "a\xC3(",          "\xC0\xAF",
+      "\"\xE2\x82\"",      "\"ok \xED\xA0\x80\"", "\x80",
+  };
+  for (const std::string &input : invalid) {
+    EXPECT_THROW(Lexer(input).Tokenize(), WrongLexingException) << input;
+  }
+
+  // 4 : A sequence cut by the end of the input moves the cursor to the end
+  // (more input may complete it)
+  Lexer test4 = Lexer("abc\xE2\x82");
+  EXPECT_THROW(test4.NextToken(), WrongLexingException);
+  EXPECT_EQ(test4.Position(), 5);
+}
+
+TEST(LexerTest, RegisteredOperators) {
+  OperatorRegistry registry;
+  OperatorType spaceship =
+      registry.RegisterInfix("<=>", 2, Associativity::LEFT);
+  OperatorType power = registry.RegisterInfix("**", 7, Associativity::RIGHT);
+
+  Lexer test1 = Lexer("a<=>b ** 2*3");
+  test1.SetOperators(registry);
+  TokenBuffer tokens = test1.Tokenize();
+
+  // 1 : "<" starts no built-in token, "**" is munched before "*"
+  ASSERT_EQ(tokens.Size(), 10);
+  EXPECT_EQ(tokens.Text(1), "<=>");
+  EXPECT_EQ(tokens.OpType(1), spaceship);
+  EXPECT_EQ(tokens.Text(4), "**");
+  EXPECT_EQ(tokens.OpType(4), power);
+  EXPECT_EQ(tokens.OpType(7), OperatorType::STAR);
+
+  // 2 : Tokens of registered operators carry their precedence
+  EXPECT_EQ(tokens.ToToken(4)->OpPtr()->Precedence(), 7);
+  EXPECT_TRUE(tokens.ToToken(4)->OpPtr()->IsRightAssociative());
+  Lexer test2 = Lexer("**");
+  test2.SetOperators(registry);
+  EXPECT_EQ(test2.NextToken()->OpPtr()->Type(), power);
+
+  // 3 : Other lexers keep the built-in operators
+  EXPECT_THROW(Lexer("a <=> b").Tokenize(), WrongLexingException);
+  EXPECT_EQ(Lexer("**").Tokenize().OpType(1), OperatorType::STAR);
+
+  // 4 : Parallel lexing and relexing use the registry too
+  std::string input;
+  for (int i = 0; i < 2000; i++)
+    input += "a <=> b ** " + std::to_string(i) + "\n";
+  Lexer test4 = Lexer(input);
+  test4.SetOperators(registry);
+  TokenBuffer parallel = test4.TokenizeParallel(4, 64);
+  Lexer serial = Lexer(input);
+  serial.SetOperators(registry);
+  EXPECT_EQ(parallel.Size(), serial.Tokenize().Size());
+  EXPECT_EQ(parallel.OpType(2), spaceship);
+}
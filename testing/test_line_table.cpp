@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "lexer.hpp"
+#include "line_table.hpp"
+#include "token_buffer.hpp"
+
+TEST(LineTableTest, Locate) {
+  const std::string source = "set a = 1\n\nset b = a\r\n  b";
+  LineTable lines = LineTable(source);
+
+  // 1
+  EXPECT_EQ(lines.Locate(0), (SourceLocation{1, 1}));
+  EXPECT_EQ(lines.Locate(4), (SourceLocation{1, 5}));
+  EXPECT_EQ(lines.Locate(9), (SourceLocation{1, 10}));
+
+  // 2 : Empty line and the line after it
+  EXPECT_EQ(lines.Locate(10), (SourceLocation{2, 1}));
+  EXPECT_EQ(lines.Locate(11), (SourceLocation{3, 1}));
+
+  // 3 : End of the source and past it
+  EXPECT_EQ(lines.Locate(source.size()), (SourceLocation{4, 4}));
+  EXPECT_EQ(lines.Locate(source.size() + 10), (SourceLocation{4, 4}));
+
+  // 4
+  EXPECT_EQ(lines.LineCount(), 4);
+  EXPECT_EQ(lines.LineText(1), "set a = 1");
+  EXPECT_EQ(lines.LineText(2), "");
+  EXPECT_EQ(lines.LineText(3), "set b = a\r");
+  EXPECT_EQ(lines.LineText(4), "  b");
+  EXPECT_EQ(lines.LineText(5), "");
+
+  // 5
+  EXPECT_EQ(LineTable("").Locate(0), (SourceLocation{1, 1}));
+  EXPECT_EQ(LineTable("\n").LineCount(), 2);
+}
+
+TEST(LineTableTest, TokenLocations) {
+  const std::string source = "set a = 1\n  a + \"x\"";
+  Lexer lexer = Lexer(source);
+  TokenBuffer tokens = lexer.Tokenize();
+  LineTable lines = LineTable(tokens.Source());
+
+  // 1 : Tokens carry their byte offset only
+  Lexer test2 = Lexer(source);
+  for (std::size_t i = 0; i < tokens.Size(); i++) {
+    EXPECT_EQ(test2.NextToken()->Offset(), tokens.Offset(i));
+    EXPECT_EQ(tokens.ToToken(i)->Offset(), tokens.Offset(i));
+  }
+
+  // 2
+  EXPECT_EQ(lines.Locate(tokens.Offset(8)), (SourceLocation{2, 3}));
+  EXPECT_EQ(lines.Locate(tokens.Offset(12)), (SourceLocation{2, 7}));
+
+  // 3 : Lexing errors report where they happened
+  try {
+    Lexer("set a = 1\nset b = #").Tokenize();
+    FAIL();
+  } catch (WrongLexingException &e) {
+    EXPECT_NE(std::string(e.what()).find("at 2:9"), std::string::npos)
+        << e.what();
+  }
+}
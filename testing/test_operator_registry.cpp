@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "operator_registry.hpp"
+
+TEST(OperatorRegistryTest, Builtin) {
+  const OperatorRegistry &registry = OperatorRegistry::Builtin();
+
+  // 1 : Longest operator at the beginning of the text
+  ASSERT_NE(registry.Match("==1"), nullptr);
+  EXPECT_EQ(registry.Match("==1")->op_type, OperatorType::EQUAL);
+  EXPECT_EQ(registry.Match("=1")->op_type, OperatorType::ASSIGN);
+  EXPECT_EQ(registry.Match("!!=")->op_type, OperatorType::NOT);
+  EXPECT_EQ(registry.Match("a"), nullptr);
+  EXPECT_EQ(registry.Match(""), nullptr);
+
+  // 2 : Exact lookups by text and by type
+  EXPECT_EQ(registry.Find("!=")->op_type, OperatorType::NOT_EQUAL);
+  EXPECT_EQ(registry.Find("!=="), nullptr);
+  EXPECT_EQ(registry.Find(OperatorType::STAR)->text, "*");
+  EXPECT_EQ(registry.Find(OperatorType::INVALID), nullptr);
+
+  // 3
+  EXPECT_TRUE(registry.StartsOperator('('));
+  EXPECT_FALSE(registry.StartsOperator('<'));
+  EXPECT_EQ(registry.MaxLength(), 2);
+}
+
+TEST(OperatorRegistryTest, RegisterInfix) {
+  OperatorRegistry registry;
+  OperatorType spaceship =
+      registry.RegisterInfix("<=>", 2, Associativity::LEFT);
+  OperatorType power = registry.RegisterInfix("**", 7, Associativity::RIGHT);
+  OperatorType arrow = registry.RegisterInfix("|||>", 2, Associativity::LEFT);
+
+  // 1 : Registered operators get their own types
+  EXPECT_GE(spaceship, OperatorType::USER_DEFINED);
+  EXPECT_NE(spaceship, power);
+  EXPECT_NE(power, arrow);
+
+  // 2 : Maximal munch over built-in and registered operators of any length
+  EXPECT_EQ(registry.Match("**2")->op_type, power);
+  EXPECT_EQ(registry.Match("*2")->op_type, OperatorType::STAR);
+  EXPECT_EQ(registry.Match("<=>b")->op_type, spaceship);
+  EXPECT_EQ(registry.Match("<=b"), nullptr);
+  EXPECT_EQ(registry.Match("|||>x")->op_type, arrow);
+  EXPECT_EQ(registry.Match("|||x"), nullptr);
+  EXPECT_EQ(registry.MaxLength(), 4);
+
+  // 3
+  const OperatorInfo *info = registry.Find(power);
+  ASSERT_NE(info, nullptr);
+  EXPECT_EQ(info->text, "**");
+  EXPECT_EQ(info->precedence, 7);
+  EXPECT_TRUE(info->infix);
+  EXPECT_EQ(info->associativity, Associativity::RIGHT);
+  EXPECT_TRUE(registry.StartsOperator('<'));
+
+  // 4 : The built-in registry is unchanged
+  EXPECT_EQ(OperatorRegistry::Builtin().Match("**")->op_type,
+            OperatorType::STAR);
+}
+
+TEST(OperatorRegistryTest, RegistrationErrors) {
+  OperatorRegistry registry;
+  registry.RegisterInfix("**", 7, Associativity::RIGHT);
+
+  const std::string texts[] = {"", "==", "**", "a+", "+1", "<\"", "< >"};
+  for (const std::string &text : texts) {
+    // 1
+    EXPECT_THROW(registry.RegisterInfix(text, 3, Associativity::LEFT),
+                 OperatorRegistrationException)
+        << text;
+  }
+
+  // 2 : Precedence out of range
+  EXPECT_THROW(registry.RegisterInfix("%", OperatorRegistry::kMinPrecedence - 1,
+                                     Associativity::LEFT),
+               OperatorRegistrationException);
+  EXPECT_THROW(registry.RegisterInfix(
+                   "%", OperatorRegistry::kMaxPrecedence + 1,
+                   Associativity::LEFT),
+               OperatorRegistrationException);
+
+  // 3 : A failed registration leaves the operator free
+  registry.RegisterInfix("%", OperatorRegistry::kMaxPrecedence,
+                         Associativity::LEFT);
+  EXPECT_NE(registry.Find("%"), nullptr);
+}
+
+TEST(OperatorRegistryTest, TrieLimit) {
+  OperatorRegistry registry;
+
+  // Operators sharing no prefix with each other, each adds a node per byte
+  const std::string starts = "#$&',.:;?@\\`|~";
+  std::size_t registered = 0;
+  bool rejected = false;
+  for (std::size_t i = 0; i < 200 && !rejected; i++) {
+    std::string text = std::string(1, starts[i % starts.size()]) +
+                       std::string(1, starts[i / starts.size() % 10]) +
+                       std::string(1000, '.');
+    try {
+      registry.RegisterInfix(text, 3, Associativity::LEFT);
+      registered++;
+    } catch (const OperatorRegistrationException &) {
+      rejected = true;
+    }
+  }
+
+  // 1 : Rejected before the 16-bit child indices wrap
+  EXPECT_TRUE(rejected);
+  EXPECT_GT(registered, 50);
+
+  // 2 : The registered operators are all still matched
+  for (std::size_t i = 0; i < registered; i++) {
+    std::string text = std::string(1, starts[i % starts.size()]) +
+                       std::string(1, starts[i / starts.size() % 10]) +
+                       std::string(1000, '.');
+    const OperatorInfo *info = registry.Match(text + "1");
+    ASSERT_NE(info, nullptr) << i;
+    EXPECT_EQ(info->text, text) << i;
+  }
+
+  // 3 : Short operators still fit
+  EXPECT_NO_THROW(registry.RegisterInfix("<<<", 3, Associativity::LEFT));
+}
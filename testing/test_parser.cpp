@@ -0,0 +1,461 @@
+#include <gtest/gtest.h>
+
+#include <queue>
+#include <span>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lexer.hpp"
+#include "operator_registry.hpp"
+#include "parser.hpp"
+#include "token_buffer.hpp"
+
+namespace {
+
+std::string PrintProgram(const Program &program) {
+  std::stringstream out;
+  out << program;
+  return out.str();
+}
+
+std::string ParseTokenBuffer(const std::string &input) {
+  Lexer lexer = Lexer(input);
+  Parser parser = Parser();
+  return PrintProgram(parser.ProduceAST(lexer.Tokenize()));
+}
+
+std::string ParseTokenQueue(const std::string &input) {
+  Lexer lexer = Lexer(input);
+  std::queue<TokenPtr> tok_queue;
+  TokenPtr tok;
+  do {
+    tok = lexer.NextToken();
+    tok_queue.push(tok);
+  } while (tok->Type() != TokenType::EOL);
+
+  Parser parser = Parser();
+  return PrintProgram(parser.ProduceAST(tok_queue));
+}
+
+}  // namespace
+
+TEST(ParserTest, TokenBufferMatchesTokenQueue) {
+  const std::string inputs[] = {
+      "1 + 2 * 3",       "set hello = (1 - 2) / 3", "hello = \"a\\\"b\"",
+      "!true == false", "-2 * --3",                "set var1",
+      "null != 1",
+  };
+
+  for (const std::string &input : inputs) {
+    // 1
+    EXPECT_EQ(ParseTokenBuffer(input), ParseTokenQueue(input)) << input;
+  }
+}
+
+TEST(ParserTest, BinaryExpression) {
+  // 1
+  EXPECT_EQ(ParseTokenBuffer("1 + 2 * 3"),
+            "ProgramStatement {\n"
+            "BinaryExpression (Left Value : NumberExpression (Value : 1), "
+            "Op Value : +, Right Value : BinaryExpression (Left Value : "
+            "NumberExpression (Value : 2), Op Value : *, Right Value : "
+            "NumberExpression (Value : 3), ), )\n"
+            "}");
+}
+
+TEST(ParserTest, UnexpectedToken) {
+  Parser parser = Parser();
+
+  // 1
+  EXPECT_THROW(parser.ProduceAST(Lexer("(1 + 2").Tokenize()),
+               UnexpectedTokenParsedException);
+
+  // 2
+  EXPECT_THROW(parser.ProduceAST(Lexer("*").Tokenize()),
+               UnexpectedTokenParsedException);
+}
+
+TEST(ParserTest, AssignmentAndNotPrecedence) {
+  // 1 : Assignment binds loosest and groups to the right
+  EXPECT_EQ(ParseTokenBuffer("a = b = 1 + 2 * 3"),
+            ParseTokenBuffer("a = (b = (1 + (2 * 3)))"));
+  EXPECT_EQ(ParseTokenBuffer("a = b == c"), ParseTokenBuffer("a = (b == c)"));
+  EXPECT_EQ(ParseTokenBuffer("(a) = 1"), ParseTokenBuffer("a = 1"));
+
+  // 2 : The operand of "!" is the rest of the expression
+  EXPECT_EQ(ParseTokenBuffer("!a == b"), ParseTokenBuffer("!(a == b)"));
+  EXPECT_EQ(ParseTokenBuffer("!a = 1 + 2"), ParseTokenBuffer("!(a = (1 + 2))"));
+  EXPECT_EQ(ParseTokenBuffer("1 == !a + 2"),
+            ParseTokenBuffer("1 == (!(a + 2))"));
+
+  // 3 : Only an identifier can be assigned
+  const std::string invalid[] = {"a + b = c", "1 = 2", "a == b = c",
+                                 "(a = b) = c", "!a = b = -c +"};
+  for (const std::string &input : invalid) {
+    EXPECT_THROW(Parser().ProduceAST(Lexer(input).Tokenize()),
+                 UnexpectedTokenParsedException)
+        << input;
+  }
+}
+
+TEST(ParserTest, WhitespaceFreeTokens) {
+  const std::string inputs[] = {
+      "1 + 2 * 3", "set hello = ( 1 - 2 ) / 3", " -2 * - -3 ",
+      "\tset var1 ", "! true == false",
+  };
+
+  for (const std::string &input : inputs) {
+    Lexer lexer = Lexer(input);
+    lexer.SetKeepWhitespace(false);
+    Parser parser = Parser();
+
+    // 1
+    EXPECT_EQ(PrintProgram(parser.ProduceAST(lexer.Tokenize())),
+              ParseTokenBuffer(input))
+        << input;
+  }
+
+  // 2 : Leading whitespace does not become a statement
+  EXPECT_EQ(ParseTokenBuffer("  1"),
+            "ProgramStatement {\nNumberExpression (Value : 1)\n}");
+}
+
+TEST(ParserTest, NumberLiterals) {
+  // 1 : The parser takes the value decoded by the lexer
+  EXPECT_EQ(ParseTokenBuffer("0x10 + -1_000"),
+            "ProgramStatement {\n"
+            "BinaryExpression (Left Value : NumberExpression (Value : 16), "
+            "Op Value : +, Right Value : NumberExpression (Value : -1000), )\n"
+            "}");
+  EXPECT_EQ(ParseTokenQueue("0b11 * 1e2"), ParseTokenBuffer("3 * 100"));
+}
+
+TEST(ParserTest, TokenSource) {
+  const std::string inputs[] = {
+      "1 + 2 * 3",       "set hello = (1 - 2) / 3", "hello = \"a\\\"b\"",
+      "!true == false", "-2 * --3",                "set var1",
+      "null != 1",
+  };
+
+  for (const std::string &input : inputs) {
+    Lexer lexer = Lexer(input);
+    Parser parser = Parser();
+
+    // 1 : Pulling the tokens gives the same AST as lexing them first
+    EXPECT_EQ(PrintProgram(parser.ProduceAST(lexer)), ParseTokenBuffer(input))
+        << input;
+  }
+
+  // 2 : A long input is parsed through a bounded window of tokens
+  std::string input;
+  for (int i = 0; i < 500; i++) {
+    input += "set a" + std::to_string(i) + " = \"x\\ty\" + " +
+             std::to_string(i) + "\n";
+  }
+  Lexer lexer = Lexer(input);
+  lexer.SetKeepWhitespace(false);
+  Parser parser = Parser();
+  EXPECT_EQ(PrintProgram(parser.ProduceAST(lexer)), ParseTokenBuffer(input));
+
+  // 3 : Errors surface once the parser reaches them
+  Lexer invalid = Lexer("1 + 2 3 +");
+  EXPECT_THROW(parser.ProduceAST(invalid), UnexpectedTokenParsedException);
+}
+
+TEST(ParserTest, RegisteredInfixOperators) {
+  OperatorRegistry registry;
+  registry.RegisterInfix("**", 7, Associativity::RIGHT);
+  registry.RegisterInfix("|>", 3, Associativity::LEFT);
+
+  auto parse = [&registry](const std::string &input) {
+    Lexer lexer = Lexer(input);
+    lexer.SetOperators(registry);
+    Parser parser = Parser();
+    parser.SetOperators(registry);
+    return PrintProgram(parser.ProduceAST(lexer.Tokenize()));
+  };
+
+  // 1 : Grouped by precedence and associativity
+  EXPECT_EQ(parse("2 ** 3 ** 2"), parse("2 ** (3 ** 2)"));
+  EXPECT_EQ(parse("1 + 2 ** 3 * 4"), parse("1 + ((2 ** 3) * 4)"));
+  EXPECT_EQ(parse("a |> b |> c + 1"), parse("(a |> b) |> (c + 1)"));
+  EXPECT_EQ(parse("a = b |> c == d"), parse("a = ((b |> c) == d)"));
+  EXPECT_NE(parse("2 ** 3 ** 2"), parse("(2 ** 3) ** 2"));
+
+  // 2 : The built-in operators keep their grouping, the right operand of a
+  // comparison takes the operators binding tighter
+  EXPECT_EQ(ParseTokenBuffer("1 - 2 - 3"), ParseTokenBuffer("(1 - 2) - 3"));
+  EXPECT_EQ(ParseTokenBuffer("a == b + 1"), ParseTokenBuffer("a == (b + 1)"));
+  EXPECT_EQ(ParseTokenBuffer("a != b == c"),
+            ParseTokenBuffer("(a != b) == c"));
+
+  // 3 : A registered operator needs both operands
+  Lexer lexer = Lexer("2 **");
+  lexer.SetOperators(registry);
+  Parser parser = Parser();
+  parser.SetOperators(registry);
+  EXPECT_THROW(parser.ProduceAST(lexer.Tokenize()),
+               UnexpectedTokenParsedException);
+}
+
+TEST(ParserTest, TokenRange) {
+  const std::string input = "set a = 1\na + 2 * 3\n\"x\" == a";
+  Lexer lexer = Lexer(input);
+  lexer.SetKeepWhitespace(false);
+  const TokenBuffer tokens = lexer.Tokenize();
+  Parser parser = Parser();
+
+  // 1 : The buffer is only read, parsing it again gives the same AST
+  const std::string whole = PrintProgram(parser.ProduceAST(tokens));
+  EXPECT_EQ(PrintProgram(parser.ProduceAST(tokens)), whole);
+  EXPECT_EQ(PrintProgram(Parser().ProduceAST(tokens, 0, tokens.Size())),
+            whole);
+
+  // 2 : A range is parsed as if it was followed by TokenType::EOL
+  EXPECT_EQ(PrintProgram(parser.ProduceAST(tokens, 4, 9)),
+            ParseTokenBuffer("a + 2 * 3"));
+  EXPECT_EQ(PrintProgram(parser.ProduceAST(tokens, 0, 4)),
+            ParseTokenBuffer("set a = 1"));
+  EXPECT_EQ(PrintProgram(parser.ProduceAST(tokens, 9, 100)),
+            ParseTokenBuffer("\"x\" == a"));
+  EXPECT_TRUE(parser.ProduceAST(tokens, 3, 3).body_.empty());
+
+  // 3 : A range cut inside a statement is an error
+  EXPECT_THROW(parser.ProduceAST(tokens, 4, 6),
+               UnexpectedTokenParsedException);
+
+  // 4 : Standalone tokens, as a contiguous list
+  std::vector<TokenPtr> tok_list;
+  Lexer list_lexer = Lexer(input);
+  do {
+    tok_list.push_back(list_lexer.NextToken());
+  } while (tok_list.back()->Type() != TokenType::EOL);
+  EXPECT_EQ(
+      PrintProgram(parser.ProduceAST(std::span<const TokenPtr>(tok_list))),
+      whole);
+}
+
+TEST(ParserTest, ErrorRecovery) {
+  const std::string input =
+      "set a = 1\n"
+      "a + * 2\n"
+      "set b = (1 + (2 -) * 3) + 4 set c = 2\n"
+      "set 3 = 4\n"
+      "a + 1\n"
+      ") b";
+  Lexer lexer = Lexer(input);
+  const TokenBuffer tokens = lexer.Tokenize();
+  Parser parser = Parser();
+  ParseResult result = parser.ProduceASTWithErrors(tokens);
+
+  // 1 : Every error is reported, at the token it was found at
+  ASSERT_EQ(result.errors.size(), 4);
+  EXPECT_EQ(result.errors[0].offset, input.find("* 2"));
+  EXPECT_EQ(result.errors[1].offset, input.find(") * 3"));
+  EXPECT_EQ(result.errors[2].offset, input.find("= 4"));
+  EXPECT_EQ(result.errors[3].offset, input.find(") b"));
+  for (const ParseError &error : result.errors) {
+    EXPECT_EQ(tokens.Offset(error.token), error.offset);
+    EXPECT_FALSE(error.message.empty());
+  }
+
+  // 2 : The valid statements are kept, the parser resumed after the
+  // parentheses of the failed one (and skipped the rest of the last line)
+  EXPECT_EQ(PrintProgram(result.program),
+            ParseTokenBuffer("set a = 1\nset c = 2\na + 1"));
+
+  // 3 : With whitespace tokens, and without any error
+  Lexer whitespace_lexer = Lexer("1 + \n2 3 /\n\n* 4 5\n6");
+  whitespace_lexer.SetKeepWhitespace(true);
+  result = parser.ProduceASTWithErrors(whitespace_lexer.Tokenize());
+  ASSERT_EQ(result.errors.size(), 1);
+  EXPECT_EQ(result.errors[0].offset, 12);
+  EXPECT_EQ(PrintProgram(result.program), ParseTokenBuffer("1 + 2 6"));
+
+  Lexer valid_lexer = Lexer("set a = 1\na");
+  result = parser.ProduceASTWithErrors(valid_lexer.Tokenize());
+  EXPECT_TRUE(result.errors.empty());
+  EXPECT_EQ(result.program.body_.size(), 2);
+
+  // 4 : "set" starts a statement even inside unclosed parentheses
+  const std::string unclosed = "(1 +\nset x = 2\n1 + * 3\nset 4 = 5";
+  Lexer unclosed_lexer = Lexer(unclosed);
+  result = parser.ProduceASTWithErrors(unclosed_lexer.Tokenize());
+  ASSERT_EQ(result.errors.size(), 3);
+  EXPECT_EQ(result.errors[0].offset, unclosed.find("set x"));
+  EXPECT_EQ(result.errors[1].offset, unclosed.find("* 3"));
+  EXPECT_EQ(result.errors[2].offset, unclosed.find("= 5"));
+  EXPECT_EQ(PrintProgram(result.program), ParseTokenBuffer("set x = 2"));
+
+  // 5 : ProduceAST still throws the first error
+  EXPECT_THROW(parser.ProduceAST(tokens), UnexpectedTokenParsedException);
+}
+
+TEST(ParserTest, Reparse) {
+  Parser parser = Parser();
+  Lexer before_lexer = Lexer("set a = 1\na + 2\nset b = a * 3\nb");
+  before_lexer.SetKeepWhitespace(false);
+  const TokenBuffer before = before_lexer.Tokenize();
+  Program previous = parser.ProduceAST(before);
+
+  // 1 : Token ranges of the statements and of their nodes
+  ASSERT_EQ(previous.statement_ranges_.size(), 4);
+  EXPECT_EQ(previous.statement_ranges_[1].begin, 4);
+  EXPECT_EQ(previous.statement_ranges_[1].end, 7);
+  std::queue<StatementPtr> body = previous.body_;
+  body.pop();
+  auto *sum = static_cast<BinaryExpression *>(body.front());
+  EXPECT_EQ(sum->token_range_.begin, 0);
+  EXPECT_EQ(sum->token_range_.end, 3);
+  EXPECT_EQ(sum->right_->token_range_.begin, 2);
+  EXPECT_EQ(sum->right_->token_range_.end, 3);
+
+  // 2 : "2" becomes "(5 * 4)", only the edited statement is parsed again
+  const std::string input = "set a = 1\na + (5 * 4)\nset b = a * 3\nb";
+  Lexer after_lexer = Lexer(input);
+  after_lexer.SetKeepWhitespace(false);
+  const TokenBuffer after = after_lexer.Tokenize();
+  const std::size_t previous_bytes = previous.RetainedBytes();
+  Program program = parser.Reparse(previous, after, TokenEdit{6, 1, 5});
+  EXPECT_EQ(PrintProgram(program), ParseTokenBuffer(input));
+  ASSERT_EQ(program.body_.size(), 4);
+  std::queue<StatementPtr> old_body = previous.body_;
+  std::queue<StatementPtr> new_body = program.body_;
+  EXPECT_EQ(new_body.front(), old_body.front());
+  new_body.pop();
+  old_body.pop();
+  EXPECT_NE(new_body.front(), old_body.front());
+  new_body.pop();
+  old_body.pop();
+  EXPECT_EQ(new_body.front(), old_body.front());
+  EXPECT_EQ(program.statement_ranges_[2].begin, 11);
+  EXPECT_EQ(program.statement_ranges_[3].end, after.Size() - 1);
+
+  // 3 : The previous Program is unchanged, the new nodes are in an arena of
+  // the result, so reparses of the same Program can run at the same time
+  EXPECT_EQ(PrintProgram(previous),
+            ParseTokenBuffer("set a = 1\na + 2\nset b = a * 3\nb"));
+  EXPECT_EQ(previous.RetainedBytes(), previous_bytes);
+  std::string concurrent[2];
+  std::thread other([&]() {
+    concurrent[1] =
+        PrintProgram(Parser().Reparse(previous, after, TokenEdit{6, 1, 5}));
+  });
+  concurrent[0] =
+      PrintProgram(Parser().Reparse(previous, after, TokenEdit{6, 1, 5}));
+  other.join();
+  EXPECT_EQ(concurrent[0], ParseTokenBuffer(input));
+  EXPECT_EQ(concurrent[1], ParseTokenBuffer(input));
+
+  // 4 : A chain of reparses (an editor loop) keeps its memory bounded
+  Program edited = previous;
+  for (int i = 0; i < 200; i++) {
+    const std::string digit = std::to_string(i % 10);
+    Lexer edit_lexer = Lexer("set a = 1\na + " + digit + "\nset b = a * 3\nb");
+    edit_lexer.SetKeepWhitespace(false);
+    const TokenBuffer edit_tokens = edit_lexer.Tokenize();
+    edited = parser.Reparse(edited, edit_tokens, TokenEdit{6, 1, 1});
+    EXPECT_LE(edited.RetainedBytes(),
+              (Parser::kMaxReparseGrowth + 1) * previous_bytes);
+  }
+  EXPECT_EQ(PrintProgram(edited),
+            ParseTokenBuffer("set a = 1\na + 9\nset b = a * 3\nb"));
+
+  // 5 : Edits which merge, split, remove and add statements, with and
+  // without whitespace tokens
+  struct Case {
+    std::string before;
+    std::string after;
+    TokenEdit edit;
+    bool keep_whitespace;
+  };
+  const Case cases[] = {
+      {"1 + 2\n3", "1 + 2 + 3", {3, 0, 1}, false},
+      {"1 + 2 + 3", "1 + 2\n3", {3, 1, 0}, false},
+      {"set a = 1\nset b = 2\na", "set a = 1\na", {4, 4, 0}, false},
+      {"a\nb", "set c = 0\na\nb", {0, 0, 4}, false},
+      {"1 * 2\n3", "1 * 2\n3 4", {4, 0, 1}, false},
+      {"1 * 2\n3", "1 * 2\n3 4", {7, 0, 2}, true},
+      {"a\n\nb = 1\nc", "a\n(b) = 1\nc", {1, 2, 4}, true},
+  };
+  for (const Case &edit_case : cases) {
+    Lexer old_lexer = Lexer(edit_case.before);
+    old_lexer.SetKeepWhitespace(edit_case.keep_whitespace);
+    const TokenBuffer old_tokens = old_lexer.Tokenize();
+    Program old_program = parser.ProduceAST(old_tokens);
+    Lexer new_lexer = Lexer(edit_case.after);
+    new_lexer.SetKeepWhitespace(edit_case.keep_whitespace);
+    const TokenBuffer new_tokens = new_lexer.Tokenize();
+    EXPECT_EQ(PrintProgram(
+                  parser.Reparse(old_program, new_tokens, edit_case.edit)),
+              ParseTokenBuffer(edit_case.after))
+        << edit_case.after;
+  }
+}
+
+TEST(ParserTest, ParallelStatements) {
+  std::string input;
+  for (int i = 0; i < 200; i++) {
+    std::string name = std::string("a").append(std::to_string(i));
+    input += "set " + name + " = (1 +\n2) * " + std::to_string(i) + "\n";
+    input += name + " = " + name + "\n- 1\n";
+    input += "\"multi\nline\" == !\n" + name + "\n";
+  }
+  Lexer lexer = Lexer(input);
+  const TokenBuffer tokens = lexer.Tokenize();
+  Parser parser = Parser();
+  Program sequential = parser.ProduceAST(tokens);
+
+  // 1 : Same statements and token ranges as parsing in order, the first
+  // chunk was parsed into an arena of its own
+  Program parallel = parser.ProduceASTParallel(tokens, 4, 1);
+  EXPECT_LT(parallel.Arena().BytesUsed(), sequential.Arena().BytesUsed());
+  EXPECT_EQ(PrintProgram(parallel), PrintProgram(sequential));
+  ASSERT_EQ(parallel.statement_ranges_.size(),
+            sequential.statement_ranges_.size());
+  for (std::size_t i = 0; i < parallel.statement_ranges_.size(); i++) {
+    EXPECT_EQ(parallel.statement_ranges_[i].begin,
+              sequential.statement_ranges_[i].begin);
+    EXPECT_EQ(parallel.statement_ranges_[i].end,
+              sequential.statement_ranges_[i].end);
+  }
+
+  // 2 : Inputs too short for a chunk per thread
+  Lexer short_lexer = Lexer("1 + 2\n3");
+  EXPECT_EQ(PrintProgram(Parser().ProduceASTParallel(short_lexer.Tokenize())),
+            ParseTokenBuffer("1 + 2\n3"));
+
+  // 3 : Reparsing keeps the nodes of every chunk alive, also once the
+  // parallel result is gone
+  std::string edited = "1 " + input;
+  Lexer edited_lexer = Lexer(edited);
+  const TokenBuffer edited_tokens = edited_lexer.Tokenize();
+  Program reparsed = parser.Reparse(parser.ProduceASTParallel(tokens, 4, 16),
+                                    edited_tokens, TokenEdit{0, 0, 2});
+  EXPECT_EQ(PrintProgram(reparsed), PrintProgram(parser.ProduceAST(
+                                        edited_tokens)));
+
+  // 4 : The same error as parsing in order, including a declaration without
+  // a value cut off from the token after it
+  const std::string invalid_inputs[] = {input + "set x = )\n1\n2",
+                                        "set x\n" + input, "set x\n1"};
+  for (const std::string &invalid : invalid_inputs) {
+    Lexer invalid_lexer = Lexer(invalid);
+    const TokenBuffer invalid_tokens = invalid_lexer.Tokenize();
+    std::string expected;
+    try {
+      parser.ProduceAST(invalid_tokens);
+    } catch (const UnexpectedTokenParsedException &e) {
+      expected = e.what();
+    }
+    ASSERT_FALSE(expected.empty());
+    try {
+      parser.ProduceASTParallel(invalid_tokens, 4, 1);
+      ADD_FAILURE() << "No error thrown";
+    } catch (const UnexpectedTokenParsedException &e) {
+      EXPECT_EQ(e.what(), expected);
+    }
+  }
+}
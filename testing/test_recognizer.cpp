@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+
+#include "lexer.hpp"
+#include "operator_registry.hpp"
+#include "parser.hpp"
+#include "recognizer.hpp"
+
+namespace {
+
+// Heap allocations made by the test binary, counted by the replaced
+// operator new below
+std::atomic<std::size_t> allocation_count{0};
+
+bool ParserAccepts(const std::string &input) {
+  try {
+    Lexer lexer = Lexer(input);
+    Parser().ProduceAST(lexer.Tokenize());
+    return true;
+  } catch (std::exception &) {
+    return false;
+  }
+}
+
+}  // namespace
+
+void *operator new(std::size_t size) {
+  allocation_count++;
+  if (void *memory = std::malloc(size == 0 ? 1 : size)) return memory;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *memory) noexcept { std::free(memory); }
+
+void operator delete(void *memory, std::size_t) noexcept {
+  std::free(memory);
+}
+
+TEST(RecognizerTest, Valid) {
+  const std::string scripts[] = {
+      "",
+      "   \n ",
+      "1 + 2 * (3 - -4) / 5",
+      "set a = \"escaped \\u00e9 \\\"\"\na = b = !(a == 3) != true\nset b",
+      "set (a) = null\n(b) = 1e+5\n--+7 + 0x1F",
+      "a b c",
+  };
+
+  for (const std::string &script : scripts) {
+    // 1
+    SyntaxCheckResult result = Recognizer(script).Check();
+    EXPECT_TRUE(result.valid) << script << ": " << result.error;
+    EXPECT_TRUE(result.error.empty()) << script;
+
+    // 2
+    EXPECT_TRUE(ParserAccepts(script)) << script;
+  }
+}
+
+TEST(RecognizerTest, FirstErrorOffset) {
+  const std::pair<std::string, std::size_t> scripts[] = {
+      {"1 +", 3},                  // Missing operand at the end
+      {"(1 + 2", 6},               // Missing ')'
+      {"set 3 = 4", 6},            // Declared name is not an identifier
+      {"a + 1 = 2", 6},            // Assigned expression is not an identifier
+      {"set a 1", 6},              // Missing '=' after the declared name
+      {"- x", 2},                  // Sign without number
+      {"1 * )", 4},                // Unexpected operator
+      {"a = 1\nb = 2 @", 12},      // Lexing error
+      {"a = \"abc", 4},            // Unterminated string
+      {"x = 0b12", 4},             // Invalid number
+      {"1 + if", 4},               // Keyword which is not an expression
+  };
+
+  for (const auto &[script, offset] : scripts) {
+    // 1
+    SyntaxCheckResult result = Recognizer(script).Check();
+    EXPECT_FALSE(result.valid) << script;
+    EXPECT_EQ(result.error_offset, offset) << script << ": " << result.error;
+    EXPECT_FALSE(result.error.empty()) << script;
+
+    // 2
+    EXPECT_FALSE(ParserAccepts(script)) << script;
+  }
+
+  // 3 : The check can be repeated
+  Recognizer recognizer = Recognizer("(1");
+  EXPECT_EQ(recognizer.Check().error_offset, 2);
+  EXPECT_EQ(recognizer.Check().error_offset, 2);
+}
+
+TEST(RecognizerTest, NestingLimit) {
+  std::size_t levels = Recognizer::kMaxDepth / 2;
+  std::string nested =
+      std::string(levels, '(') + "1" + std::string(levels, ')');
+
+  // 1
+  SyntaxCheckResult result = Recognizer(nested).Check();
+  EXPECT_FALSE(result.valid);
+  EXPECT_LT(result.error_offset, levels);
+
+  // 2
+  levels = Recognizer::kMaxDepth / 8;
+  nested = std::string(levels, '(') + "1" + std::string(levels, ')');
+  EXPECT_TRUE(Recognizer(nested).Check().valid);
+}
+
+TEST(RecognizerTest, MatchesParser) {
+  // Random token sequences, the Recognizer and the Parser agree on each
+  const char *words[] = {"set", "a", "b", "1", "\"s\"", "true", "null",
+                         "=",   "==", "!=", "+", "-",     "*",    "/",
+                         "!",   "(",  ")",  "if", "\n"};
+  std::mt19937 rng(17);
+
+  for (int i = 0; i < 3000; i++) {
+    std::string script;
+    std::size_t count = rng() % 10;
+    for (std::size_t j = 0; j < count; j++) {
+      script += words[rng() % (sizeof(words) / sizeof(words[0]))];
+      script += ' ';
+    }
+
+    // 1
+    EXPECT_EQ(Recognizer(script).Check().valid, ParserAccepts(script))
+        << script;
+  }
+}
+
+TEST(RecognizerTest, RegisteredOperators) {
+  OperatorRegistry registry;
+  registry.RegisterInfix("**", 7, Associativity::RIGHT);
+  registry.RegisterInfix("<=>", 2, Associativity::LEFT);
+
+  // 1
+  Recognizer valid = Recognizer("set a = 2 ** 3 ** 2 <=> (b ** -1)\na <=> 1");
+  valid.SetOperators(registry);
+  EXPECT_TRUE(valid.Check().valid);
+
+  // 2
+  Recognizer invalid = Recognizer("a = 2 ** ** 3");
+  invalid.SetOperators(registry);
+  EXPECT_EQ(invalid.Check().error_offset, 9);
+
+  // 3 : Unknown to the built-in registry
+  EXPECT_FALSE(Recognizer("a <=> b").Check().valid);
+}
+
+TEST(RecognizerTest, NoAllocation) {
+  std::string script;
+  for (int i = 0; i < 100; i++) {
+    script += "set a" + std::to_string(i) + " = (1 + 2.5e3) * -0x1F / b\n";
+    script += "\"escaped \\u00e9 \\\" string\" == !(a = null) != true\n";
+  }
+  Recognizer recognizer = Recognizer(script);
+
+  // 1 : Checking a valid script allocates nothing
+  std::size_t before = allocation_count;
+  SyntaxCheckResult result = recognizer.Check();
+  std::size_t after = allocation_count;
+  EXPECT_TRUE(result.valid) << result.error;
+  EXPECT_EQ(after, before);
+
+  // 2 : Only an error builds its message (which the counter sees)
+  // The Recognizer borrows the script, which must outlive it
+  const std::string invalid_script = script + "set 1 = 2 with a long message";
+  Recognizer invalid = Recognizer(invalid_script);
+  before = allocation_count;
+  result = invalid.Check();
+  after = allocation_count;
+  EXPECT_FALSE(result.valid);
+  EXPECT_GT(after, before);
+}
@@ -1,12 +1,32 @@
 #include <gtest/gtest.h>
 
-#include <memory>
+#include <string>
+#include <utility>
 
+#include "ast_arena.hpp"
+#include "flat_ast.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
 #include "runtime.hpp"
 
+namespace {
+
+// Owns the nodes of the hand-built programs for the whole test run
+AstArena &TestArena() {
+  static AstArena arena;
+  return arena;
+}
+
+template <typename T, typename... Args>
+T *New(Args &&...args) {
+  return TestArena().New<T>(std::forward<Args>(args)...);
+}
+
+}  // namespace
+
 TEST(EvaluaterTest, NumberEvaluation) {
   std::queue<StatementPtr> stmtqueue1;
-  stmtqueue1.push(std::make_shared<NumberExpression>(1));
+  stmtqueue1.push(New<NumberExpression>(1));
 
   Evaluater test1 = Evaluater();
   std::string test1Result = test1.EvaluateProgram(stmtqueue1);
@@ -15,7 +35,7 @@ TEST(EvaluaterTest, NumberEvaluation) {
   EXPECT_EQ(test1Result, "1");
 
   std::queue<StatementPtr> stmtqueue2;
-  stmtqueue2.push(std::make_shared<NumberExpression>(-1.000001));
+  stmtqueue2.push(New<NumberExpression>(-1.000001));
 
   Evaluater test2 = Evaluater();
   std::string test2Result = test2.EvaluateProgram(stmtqueue2);
@@ -24,7 +44,7 @@ TEST(EvaluaterTest, NumberEvaluation) {
   EXPECT_EQ(test2Result, "-1.0000009999999999");
 
   std::queue<StatementPtr> stmtqueue3;
-  stmtqueue3.push(std::make_shared<NumberExpression>(-111.0000000001));
+  stmtqueue3.push(New<NumberExpression>(-111.0000000001));
 
   Evaluater test3 = Evaluater();
   std::string test3Result = test3.EvaluateProgram(stmtqueue3);
@@ -36,7 +56,7 @@ TEST(EvaluaterTest, NumberEvaluation) {
 TEST(EvaluaterTest, BooleanEvaluation) {
   {
     std::queue<StatementPtr> stmtqueue1;
-    stmtqueue1.push(std::make_shared<BooleanExpression>("true"));
+    stmtqueue1.push(New<BooleanExpression>("true"));
 
     Evaluater test1 = Evaluater();
     std::string test1Result = test1.EvaluateProgram(stmtqueue1);
@@ -46,7 +66,7 @@ TEST(EvaluaterTest, BooleanEvaluation) {
   }
   {
     std::queue<StatementPtr> stmtqueue2;
-    stmtqueue2.push(std::make_shared<BooleanExpression>("false"));
+    stmtqueue2.push(New<BooleanExpression>("false"));
 
     Evaluater test2 = Evaluater();
     std::string test2Result = test2.EvaluateProgram(stmtqueue2);
@@ -58,8 +78,8 @@ TEST(EvaluaterTest, BooleanEvaluation) {
 
 TEST(EvaluaterTest, NotEvaluation) {
   std::queue<StatementPtr> stmtqueue1;
-  stmtqueue1.push(std::make_shared<NotExpression>(
-      std::make_shared<BooleanExpression>("true")));
+  stmtqueue1.push(New<NotExpression>(
+      New<BooleanExpression>("true")));
 
   Evaluater test1 = Evaluater();
   std::string test1Result = test1.EvaluateProgram(stmtqueue1);
@@ -68,8 +88,8 @@ TEST(EvaluaterTest, NotEvaluation) {
   EXPECT_EQ(test1Result, "false");
 
   std::queue<StatementPtr> stmtqueue2;
-  stmtqueue2.push(std::make_shared<NotExpression>(
-      std::make_shared<BooleanExpression>("false")));
+  stmtqueue2.push(New<NotExpression>(
+      New<BooleanExpression>("false")));
 
   Evaluater test2 = Evaluater();
   std::string test2Result = test2.EvaluateProgram(stmtqueue2);
@@ -78,8 +98,8 @@ TEST(EvaluaterTest, NotEvaluation) {
   EXPECT_EQ(test2Result, "true");
 
   std::queue<StatementPtr> stmtqueue3;
-  stmtqueue3.push(std::make_shared<NotExpression>(
-      std::make_shared<BooleanExpression>("0")));
+  stmtqueue3.push(New<NotExpression>(
+      New<BooleanExpression>("0")));
 
   Evaluater test3 = Evaluater();
   std::string test3Result = test3.EvaluateProgram(stmtqueue3);
@@ -89,8 +109,8 @@ TEST(EvaluaterTest, NotEvaluation) {
 
   std::queue<StatementPtr> stmtqueue4;
   stmtqueue4.push(
-      std::make_shared<NotExpression>(std::make_shared<NotExpression>(
-          std::make_shared<BooleanExpression>("1"))));
+      New<NotExpression>(New<NotExpression>(
+          New<BooleanExpression>("1"))));
 
   Evaluater test4 = Evaluater();
   std::string test4Result = test4.EvaluateProgram(stmtqueue4);
@@ -99,8 +119,8 @@ TEST(EvaluaterTest, NotEvaluation) {
   EXPECT_EQ(test4Result, "false");
 
   std::queue<StatementPtr> stmtqueue5;
-  stmtqueue5.push(std::make_shared<NotExpression>(
-      std::make_shared<BooleanExpression>("-1")));
+  stmtqueue5.push(New<NotExpression>(
+      New<BooleanExpression>("-1")));
 
   Evaluater test5 = Evaluater();
   std::string test5Result = test5.EvaluateProgram(stmtqueue5);
@@ -110,8 +130,8 @@ TEST(EvaluaterTest, NotEvaluation) {
 
   std::queue<StatementPtr> stmtqueue6;
   stmtqueue6.push(
-      std::make_shared<NotExpression>(std::make_shared<NotExpression>(
-          std::make_shared<BooleanExpression>("10.111111111"))));
+      New<NotExpression>(New<NotExpression>(
+          New<BooleanExpression>("10.111111111"))));
 
   Evaluater test6 = Evaluater();
   std::string test6Result = test6.EvaluateProgram(stmtqueue6);
@@ -122,7 +142,7 @@ TEST(EvaluaterTest, NotEvaluation) {
 
 TEST(EvaluaterTest, NullEvaluation) {
   std::queue<StatementPtr> stmtqueue;
-  stmtqueue.push(std::make_shared<NullExpression>());
+  stmtqueue.push(New<NullExpression>());
 
   Evaluater test1 = Evaluater();
   std::string test1Result = test1.EvaluateProgram(stmtqueue);
@@ -135,9 +155,9 @@ TEST(EvaluaterTest, BinaryExpression) {
   {
     std::queue<StatementPtr> stmtqueue;
     // 1 + 2
-    stmtqueue.push(std::make_shared<BinaryExpression>(
-        std::make_shared<NumberExpression>(1), "+",
-        std::make_shared<NumberExpression>(2)));
+    stmtqueue.push(New<BinaryExpression>(
+        New<NumberExpression>(1), "+",
+        New<NumberExpression>(2)));
 
     Evaluater test1 = Evaluater();
     std::string test1Result = test1.EvaluateProgram(stmtqueue);
@@ -148,9 +168,9 @@ TEST(EvaluaterTest, BinaryExpression) {
   {
     std::queue<StatementPtr> stmtqueue2;
     // 0 - 2
-    stmtqueue2.push(std::make_shared<BinaryExpression>(
-        std::make_shared<NumberExpression>(0), "-",
-        std::make_shared<NumberExpression>(2)));
+    stmtqueue2.push(New<BinaryExpression>(
+        New<NumberExpression>(0), "-",
+        New<NumberExpression>(2)));
 
     Evaluater test2 = Evaluater();
     std::string test2Result = test2.EvaluateProgram(stmtqueue2);
@@ -161,11 +181,11 @@ TEST(EvaluaterTest, BinaryExpression) {
   {
     std::queue<StatementPtr> stmtqueue3;
     // 3 * ( 3 + 2 )
-    stmtqueue3.push(std::make_shared<BinaryExpression>(
-        std::make_shared<NumberExpression>(3), "*",
-        std::make_shared<BinaryExpression>(
-            std::make_shared<NumberExpression>(3), "+",
-            std::make_shared<NumberExpression>(2))));
+    stmtqueue3.push(New<BinaryExpression>(
+        New<NumberExpression>(3), "*",
+        New<BinaryExpression>(
+            New<NumberExpression>(3), "+",
+            New<NumberExpression>(2))));
 
     Evaluater test3 = Evaluater();
     std::string test3Result = test3.EvaluateProgram(stmtqueue3);
@@ -176,11 +196,11 @@ TEST(EvaluaterTest, BinaryExpression) {
   {
     std::queue<StatementPtr> stmtqueue4;
     // 4 - ( 3 + null )
-    stmtqueue4.push(std::make_shared<BinaryExpression>(
-        std::make_shared<NumberExpression>(4), "-",
-        std::make_shared<BinaryExpression>(
-            std::make_shared<NumberExpression>(3), "+",
-            std::make_shared<NullExpression>())));
+    stmtqueue4.push(New<BinaryExpression>(
+        New<NumberExpression>(4), "-",
+        New<BinaryExpression>(
+            New<NumberExpression>(3), "+",
+            New<NullExpression>())));
 
     Evaluater test4 = Evaluater();
     std::string test4Result = test4.EvaluateProgram(stmtqueue4);
@@ -191,9 +211,9 @@ TEST(EvaluaterTest, BinaryExpression) {
   {
     std::queue<StatementPtr> stmtqueue5;
     // null - null
-    stmtqueue5.push(std::make_shared<BinaryExpression>(
-        std::make_shared<NullExpression>(), "-",
-        std::make_shared<NullExpression>()));
+    stmtqueue5.push(New<BinaryExpression>(
+        New<NullExpression>(), "-",
+        New<NullExpression>()));
 
     Evaluater test5 = Evaluater();
     std::string test5Result = test5.EvaluateProgram(stmtqueue5);
@@ -204,9 +224,9 @@ TEST(EvaluaterTest, BinaryExpression) {
   {
     std::queue<StatementPtr> stmtqueue6;
     // true + true
-    stmtqueue6.push(std::make_shared<BinaryExpression>(
-        std::make_shared<BooleanExpression>("true"), "+",
-        std::make_shared<BooleanExpression>("true")));
+    stmtqueue6.push(New<BinaryExpression>(
+        New<BooleanExpression>("true"), "+",
+        New<BooleanExpression>("true")));
 
     Evaluater test6 = Evaluater();
     std::string test6Result = test6.EvaluateProgram(stmtqueue6);
@@ -217,9 +237,9 @@ TEST(EvaluaterTest, BinaryExpression) {
   {
     std::queue<StatementPtr> stmtqueue7;
     // true - false
-    stmtqueue7.push(std::make_shared<BinaryExpression>(
-        std::make_shared<BooleanExpression>("true"), "-",
-        std::make_shared<BooleanExpression>("false")));
+    stmtqueue7.push(New<BinaryExpression>(
+        New<BooleanExpression>("true"), "-",
+        New<BooleanExpression>("false")));
 
     Evaluater test7 = Evaluater();
     std::string test7Result = test7.EvaluateProgram(stmtqueue7);
@@ -230,9 +250,9 @@ TEST(EvaluaterTest, BinaryExpression) {
   {
     std::queue<StatementPtr> stmtqueue8;
     // true - false
-    stmtqueue8.push(std::make_shared<BinaryExpression>(
-        std::make_shared<BooleanExpression>("true"), "*",
-        std::make_shared<BooleanExpression>("true")));
+    stmtqueue8.push(New<BinaryExpression>(
+        New<BooleanExpression>("true"), "*",
+        New<BooleanExpression>("true")));
 
     Evaluater test8 = Evaluater();
     std::string test8Result = test8.EvaluateProgram(stmtqueue8);
@@ -243,9 +263,9 @@ TEST(EvaluaterTest, BinaryExpression) {
   {
     std::queue<StatementPtr> stmtqueue9;
     // true + 10
-    stmtqueue9.push(std::make_shared<BinaryExpression>(
-        std::make_shared<BooleanExpression>("true"), "+",
-        std::make_shared<NumberExpression>(10)));
+    stmtqueue9.push(New<BinaryExpression>(
+        New<BooleanExpression>("true"), "+",
+        New<NumberExpression>(10)));
 
     Evaluater test9 = Evaluater();
     std::string test9Result = test9.EvaluateProgram(stmtqueue9);
@@ -256,9 +276,9 @@ TEST(EvaluaterTest, BinaryExpression) {
   {
     std::queue<StatementPtr> stmtqueue10;
     // false / 1
-    stmtqueue10.push(std::make_shared<BinaryExpression>(
-        std::make_shared<BooleanExpression>("false"), "/",
-        std::make_shared<NumberExpression>(1)));
+    stmtqueue10.push(New<BinaryExpression>(
+        New<BooleanExpression>("false"), "/",
+        New<NumberExpression>(1)));
 
     Evaluater test10 = Evaluater();
     std::string test10Result = test10.EvaluateProgram(stmtqueue10);
@@ -269,9 +289,9 @@ TEST(EvaluaterTest, BinaryExpression) {
   {
     std::queue<StatementPtr> stmtqueue11;
     // 0.1 + 0.2
-    stmtqueue11.push(std::make_shared<BinaryExpression>(
-        std::make_shared<NumberExpression>(0.1), "+",
-        std::make_shared<NumberExpression>(0.2)));
+    stmtqueue11.push(New<BinaryExpression>(
+        New<NumberExpression>(0.1), "+",
+        New<NumberExpression>(0.2)));
 
     Evaluater test11 = Evaluater();
     std::string test11Result = test11.EvaluateProgram(stmtqueue11);
@@ -279,13 +299,26 @@ TEST(EvaluaterTest, BinaryExpression) {
     // 11
     EXPECT_EQ(test11Result, "0.3");
   }
+  {
+    std::queue<StatementPtr> stmtqueue12;
+    // 10 + true
+    stmtqueue12.push(New<BinaryExpression>(
+        New<NumberExpression>(10), "+",
+        New<BooleanExpression>("true")));
+
+    Evaluater test12 = Evaluater();
+    std::string test12Result = test12.EvaluateProgram(stmtqueue12);
+
+    // 12
+    EXPECT_EQ(test12Result, "11");
+  }
 }
 
 TEST(EvaluaterTest, StringExpression) {
   {
     std::queue<StatementPtr> stmtqueue;
     // "hello"
-    stmtqueue.push(std::make_shared<StringExpression>("hello"));
+    stmtqueue.push(New<StringExpression>("hello"));
 
     Evaluater test1 = Evaluater();
     std::string test1Result = test1.EvaluateProgram(stmtqueue);
@@ -296,7 +329,7 @@ TEST(EvaluaterTest, StringExpression) {
   {
     std::queue<StatementPtr> stmtqueue2;
     // "   hello"
-    stmtqueue2.push(std::make_shared<StringExpression>("   hello"));
+    stmtqueue2.push(New<StringExpression>("   hello"));
 
     Evaluater test2 = Evaluater();
     std::string test2Result = test2.EvaluateProgram(stmtqueue2);
@@ -307,7 +340,7 @@ TEST(EvaluaterTest, StringExpression) {
   {
     std::queue<StatementPtr> stmtqueue3;
     // "hello    "
-    stmtqueue3.push(std::make_shared<StringExpression>("hello    "));
+    stmtqueue3.push(New<StringExpression>("hello    "));
 
     Evaluater test3 = Evaluater();
     std::string test3Result = test3.EvaluateProgram(stmtqueue3);
@@ -318,7 +351,7 @@ TEST(EvaluaterTest, StringExpression) {
   {
     std::queue<StatementPtr> stmtqueue4;
     // "hello 😂 World"
-    stmtqueue4.push(std::make_shared<StringExpression>("hello 😂 World"));
+    stmtqueue4.push(New<StringExpression>("hello 😂 World"));
 
     Evaluater test4 = Evaluater();
     std::string test4Result = test4.EvaluateProgram(stmtqueue4);
@@ -333,9 +366,9 @@ TEST(EvaluaterTest, VariableDeclaration) {
     std::queue<StatementPtr> stmtqueue;
     // set hello = 1
     // hello
-    stmtqueue.push(std::make_shared<VariableDeclarationStatement>(
-        "hello", std::make_shared<NumberExpression>(1)));
-    stmtqueue.push(std::make_shared<IdentifierExpression>("hello"));
+    stmtqueue.push(New<VariableDeclarationStatement>(
+        "hello", New<NumberExpression>(1)));
+    stmtqueue.push(New<IdentifierExpression>("hello"));
 
     Evaluater test1 = Evaluater();
     std::string test1Result = test1.EvaluateProgram(stmtqueue);
@@ -347,8 +380,8 @@ TEST(EvaluaterTest, VariableDeclaration) {
     std::queue<StatementPtr> stmtqueue2;
     // set var1
     // var1
-    stmtqueue2.push(std::make_shared<VariableDeclarationStatement>("var1"));
-    stmtqueue2.push(std::make_shared<IdentifierExpression>("var1"));
+    stmtqueue2.push(New<VariableDeclarationStatement>("var1"));
+    stmtqueue2.push(New<IdentifierExpression>("var1"));
 
     Evaluater test2 = Evaluater();
     std::string test2Result = test2.EvaluateProgram(stmtqueue2);
@@ -360,9 +393,9 @@ TEST(EvaluaterTest, VariableDeclaration) {
     std::queue<StatementPtr> stmtqueue3;
     // set testingVar = true
     // testingVar
-    stmtqueue3.push(std::make_shared<VariableDeclarationStatement>(
-        "testingVar", std::make_shared<BooleanExpression>("true")));
-    stmtqueue3.push(std::make_shared<IdentifierExpression>("testingVar"));
+    stmtqueue3.push(New<VariableDeclarationStatement>(
+        "testingVar", New<BooleanExpression>("true")));
+    stmtqueue3.push(New<IdentifierExpression>("testingVar"));
 
     Evaluater test3 = Evaluater();
     std::string test3Result = test3.EvaluateProgram(stmtqueue3);
@@ -378,11 +411,11 @@ TEST(EvaluaterTest, VariableAssignment) {
     // set hello = 1
     // hello = 321
     // hello
-    stmtqueue.push(std::make_shared<VariableDeclarationStatement>(
-        "hello", std::make_shared<NumberExpression>(1)));
-    stmtqueue.push(std::make_shared<VariableAssignExpression>(
-        "hello", std::make_shared<NumberExpression>(321)));
-    stmtqueue.push(std::make_shared<IdentifierExpression>("hello"));
+    stmtqueue.push(New<VariableDeclarationStatement>(
+        "hello", New<NumberExpression>(1)));
+    stmtqueue.push(New<VariableAssignExpression>(
+        "hello", New<NumberExpression>(321)));
+    stmtqueue.push(New<IdentifierExpression>("hello"));
 
     Evaluater test1 = Evaluater();
     std::string test1Result = test1.EvaluateProgram(stmtqueue);
@@ -395,10 +428,10 @@ TEST(EvaluaterTest, VariableAssignment) {
     // set var1
     // var1 = null
     // var1
-    stmtqueue2.push(std::make_shared<VariableDeclarationStatement>("var1"));
-    stmtqueue2.push(std::make_shared<VariableAssignExpression>(
-        "var1", std::make_shared<NullExpression>()));
-    stmtqueue2.push(std::make_shared<IdentifierExpression>("var1"));
+    stmtqueue2.push(New<VariableDeclarationStatement>("var1"));
+    stmtqueue2.push(New<VariableAssignExpression>(
+        "var1", New<NullExpression>()));
+    stmtqueue2.push(New<IdentifierExpression>("var1"));
 
     Evaluater test2 = Evaluater();
     std::string test2Result = test2.EvaluateProgram(stmtqueue2);
@@ -414,17 +447,17 @@ TEST(EvaluaterTest, VariableAssignment) {
     // testingVar2 = 521
     // set testingVar4 = null
     // testingVar2
-    stmtqueue3.push(std::make_shared<VariableDeclarationStatement>(
-        "testingVar", std::make_shared<BooleanExpression>("true")));
-    stmtqueue3.push(std::make_shared<VariableDeclarationStatement>(
-        "testingVar2", std::make_shared<BooleanExpression>("false")));
-    stmtqueue3.push(std::make_shared<VariableDeclarationStatement>(
-        "testingVar3", std::make_shared<NumberExpression>(123)));
-    stmtqueue3.push(std::make_shared<VariableAssignExpression>(
-        "testingVar2", std::make_shared<NumberExpression>(521)));
-    stmtqueue3.push(std::make_shared<VariableDeclarationStatement>(
-        "testingVar4", std::make_shared<NullExpression>()));
-    stmtqueue3.push(std::make_shared<IdentifierExpression>("testingVar2"));
+    stmtqueue3.push(New<VariableDeclarationStatement>(
+        "testingVar", New<BooleanExpression>("true")));
+    stmtqueue3.push(New<VariableDeclarationStatement>(
+        "testingVar2", New<BooleanExpression>("false")));
+    stmtqueue3.push(New<VariableDeclarationStatement>(
+        "testingVar3", New<NumberExpression>(123)));
+    stmtqueue3.push(New<VariableAssignExpression>(
+        "testingVar2", New<NumberExpression>(521)));
+    stmtqueue3.push(New<VariableDeclarationStatement>(
+        "testingVar4", New<NullExpression>()));
+    stmtqueue3.push(New<IdentifierExpression>("testingVar2"));
 
     Evaluater test3 = Evaluater();
     std::string test3Result = test3.EvaluateProgram(stmtqueue3);
@@ -438,9 +471,9 @@ TEST(EvaluaterTest, ValueComparison) {
   {
     std::queue<StatementPtr> stmtqueue;
     // 1234 == 1234
-    stmtqueue.push(std::make_shared<ComparisonExpression>(
-        std::make_shared<NumberExpression>(1234),
-        "==", std::make_shared<NumberExpression>(1234)));
+    stmtqueue.push(New<ComparisonExpression>(
+        New<NumberExpression>(1234),
+        "==", New<NumberExpression>(1234)));
 
     Evaluater test1 = Evaluater();
     std::string test1Result = test1.EvaluateProgram(stmtqueue);
@@ -451,9 +484,9 @@ TEST(EvaluaterTest, ValueComparison) {
   {
     std::queue<StatementPtr> stmtqueue2;
     // 10 != 11
-    stmtqueue2.push(std::make_shared<ComparisonExpression>(
-        std::make_shared<NumberExpression>(10),
-        "!=", std::make_shared<NumberExpression>(11)));
+    stmtqueue2.push(New<ComparisonExpression>(
+        New<NumberExpression>(10),
+        "!=", New<NumberExpression>(11)));
 
     Evaluater test2 = Evaluater();
     std::string test2Result = test2.EvaluateProgram(stmtqueue2);
@@ -464,9 +497,9 @@ TEST(EvaluaterTest, ValueComparison) {
   {
     std::queue<StatementPtr> stmtqueue3;
     // null == null
-    stmtqueue3.push(std::make_shared<ComparisonExpression>(
-        std::make_shared<NullExpression>(),
-        "==", std::make_shared<NullExpression>()));
+    stmtqueue3.push(New<ComparisonExpression>(
+        New<NullExpression>(),
+        "==", New<NullExpression>()));
 
     Evaluater test3 = Evaluater();
     std::string test3Result = test3.EvaluateProgram(stmtqueue3);
@@ -478,11 +511,11 @@ TEST(EvaluaterTest, ValueComparison) {
     std::queue<StatementPtr> stmtqueue4;
     // set hello = 1
     // hello == 1
-    stmtqueue4.push(std::make_shared<VariableDeclarationStatement>(
-        "hello", std::make_shared<NumberExpression>(1)));
-    stmtqueue4.push(std::make_shared<ComparisonExpression>(
-        std::make_shared<IdentifierExpression>("hello"),
-        "==", std::make_shared<NumberExpression>(1)));
+    stmtqueue4.push(New<VariableDeclarationStatement>(
+        "hello", New<NumberExpression>(1)));
+    stmtqueue4.push(New<ComparisonExpression>(
+        New<IdentifierExpression>("hello"),
+        "==", New<NumberExpression>(1)));
 
     Evaluater test4 = Evaluater();
     std::string test4Result = test4.EvaluateProgram(stmtqueue4);
@@ -493,9 +526,9 @@ TEST(EvaluaterTest, ValueComparison) {
   {
     std::queue<StatementPtr> stmtqueue5;
     // true == 1
-    stmtqueue5.push(std::make_shared<ComparisonExpression>(
-        std::make_shared<BooleanExpression>("true"),
-        "==", std::make_shared<NumberExpression>(1)));
+    stmtqueue5.push(New<ComparisonExpression>(
+        New<BooleanExpression>("true"),
+        "==", New<NumberExpression>(1)));
 
     Evaluater test5 = Evaluater();
     std::string test5Result = test5.EvaluateProgram(stmtqueue5);
@@ -506,9 +539,9 @@ TEST(EvaluaterTest, ValueComparison) {
   {
     std::queue<StatementPtr> stmtqueue6;
     // false == 0
-    stmtqueue6.push(std::make_shared<ComparisonExpression>(
-        std::make_shared<BooleanExpression>("false"),
-        "==", std::make_shared<NumberExpression>(0)));
+    stmtqueue6.push(New<ComparisonExpression>(
+        New<BooleanExpression>("false"),
+        "==", New<NumberExpression>(0)));
 
     Evaluater test6 = Evaluater();
     std::string test6Result = test6.EvaluateProgram(stmtqueue6);
@@ -519,9 +552,9 @@ TEST(EvaluaterTest, ValueComparison) {
   {
     std::queue<StatementPtr> stmtqueue7;
     // false == -1
-    stmtqueue7.push(std::make_shared<ComparisonExpression>(
-        std::make_shared<BooleanExpression>("false"),
-        "==", std::make_shared<NumberExpression>(-1)));
+    stmtqueue7.push(New<ComparisonExpression>(
+        New<BooleanExpression>("false"),
+        "==", New<NumberExpression>(-1)));
 
     Evaluater test7 = Evaluater();
     std::string test7Result = test7.EvaluateProgram(stmtqueue7);
@@ -532,9 +565,9 @@ TEST(EvaluaterTest, ValueComparison) {
   {
     std::queue<StatementPtr> stmtqueue8;
     // -10 == false
-    stmtqueue8.push(std::make_shared<ComparisonExpression>(
-        std::make_shared<NumberExpression>(-10),
-        "==", std::make_shared<BooleanExpression>("false")));
+    stmtqueue8.push(New<ComparisonExpression>(
+        New<NumberExpression>(-10),
+        "==", New<BooleanExpression>("false")));
 
     Evaluater test8 = Evaluater();
     std::string test8Result = test8.EvaluateProgram(stmtqueue8);
@@ -545,9 +578,9 @@ TEST(EvaluaterTest, ValueComparison) {
   {
     std::queue<StatementPtr> stmtqueue9;
     // 123 != false
-    stmtqueue9.push(std::make_shared<ComparisonExpression>(
-        std::make_shared<NumberExpression>(123),
-        "!=", std::make_shared<BooleanExpression>("false")));
+    stmtqueue9.push(New<ComparisonExpression>(
+        New<NumberExpression>(123),
+        "!=", New<BooleanExpression>("false")));
 
     Evaluater test9 = Evaluater();
     std::string test9Result = test9.EvaluateProgram(stmtqueue9);
@@ -556,3 +589,32 @@ TEST(EvaluaterTest, ValueComparison) {
     EXPECT_EQ(test9Result, "true");
   }
 }
+
+TEST(EvaluaterTest, FlatProgram) {
+  std::string scripts[] = {
+      "1 + 2 * 3 - 4 / 2",
+      "set x = 5\nset y = x * 2\nx = y - 1\nx == 9",
+      "!(1 == true) != !0.5",
+      "set name = \"hello\"\nname + 1",
+      "set x = !null\nset empty",
+  };
+
+  for (const std::string &script : scripts) {
+    Lexer lexer = Lexer(script);
+    Program program = Parser().ProduceAST(lexer.Tokenize());
+
+    // 1 : The flat walk gives the same result as the tree
+    Evaluater tree_evaluater = Evaluater();
+    Evaluater flat_evaluater = Evaluater();
+    EXPECT_EQ(flat_evaluater.EvaluateProgram(FlatAst(program)),
+              tree_evaluater.EvaluateProgram(program))
+        << script;
+  }
+
+  // 2 : Errors are the same as well
+  Lexer lexer = Lexer("set x = 1\nset x = 2");
+  FlatAst flat_ast = FlatAst(Parser().ProduceAST(lexer.Tokenize()));
+  Evaluater evaluater = Evaluater();
+  EXPECT_THROW(evaluater.EvaluateProgram(flat_ast),
+               VariableAlreadyDeclaredException);
+}
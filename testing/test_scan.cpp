@@ -0,0 +1,209 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "scan.hpp"
+
+// Each run is placed at every alignment and length around the 16/32 byte
+// strides so the vector body and the scalar tail are both exercised.
+
+namespace {
+
+// Run the checks with every kernel the CPU supports, not only the fastest
+// one, then go back to the fastest one
+template <typename Checks>
+void ForEachKernel(Checks checks) {
+  const ScanKernel active = ActiveScanKernel();
+  for (ScanKernel kernel :
+       {ScanKernel::SCALAR, ScanKernel::SSE2, ScanKernel::AVX2}) {
+    if (!SetScanKernel(kernel)) continue;
+    SCOPED_TRACE(static_cast<int>(kernel));
+    checks();
+  }
+  SetScanKernel(active);
+}
+
+}  // namespace
+
+TEST(ScanTest, SkipWhitespace) {
+  ForEachKernel([]() {
+    for (std::size_t prefix = 0; prefix < 40; prefix++) {
+      for (std::size_t run = 0; run < 80; run++) {
+        std::string text = std::string(prefix, 'a') +
+                           std::string(run, " \t\n\r"[run % 4]) + "b" +
+                           std::string(40, ' ');
+
+        // 1
+        EXPECT_EQ(SkipWhitespace(text, prefix), prefix + run);
+      }
+    }
+
+    // 2
+    EXPECT_EQ(SkipWhitespace("   ", 0), 3);
+  });
+}
+
+TEST(ScanTest, SkipIdentifier) {
+  ForEachKernel([]() {
+    for (std::size_t prefix = 0; prefix < 40; prefix++) {
+      for (std::size_t run = 0; run < 80; run++) {
+        std::string text = std::string(prefix, ' ') +
+                           std::string(run, "aZ09q"[run % 5]) + "+" +
+                           std::string(40, 'x');
+
+        // 1
+        EXPECT_EQ(SkipIdentifier(text, prefix), prefix + run);
+      }
+    }
+
+    // 2 : Characters next to the letter/digit ranges are not identifiers
+    EXPECT_EQ(SkipIdentifier("abc@", 0), 3);
+    EXPECT_EQ(SkipIdentifier("abc[", 0), 3);
+    EXPECT_EQ(SkipIdentifier("abc`", 0), 3);
+    EXPECT_EQ(SkipIdentifier("abc{", 0), 3);
+    EXPECT_EQ(SkipIdentifier("abc:", 0), 3);
+    EXPECT_EQ(SkipIdentifier("abc/", 0), 3);
+    EXPECT_EQ(SkipIdentifier("abc\xC3\xA9", 0), 3);
+  });
+}
+
+TEST(ScanTest, SkipDigits) {
+  ForEachKernel([]() {
+    for (std::size_t run = 0; run < 80; run++) {
+      std::string text = std::string(run, '7') + "." + std::string(40, '1');
+
+      // 1
+      EXPECT_EQ(SkipDigits(text, 0), run);
+    }
+  });
+}
+
+TEST(ScanTest, FindQuoteOrBackslash) {
+  ForEachKernel([]() {
+    for (std::size_t run = 0; run < 80; run++) {
+      std::string text = std::string(run, 'x') + (run % 2 ? "\"" : "\\") +
+                         std::string(40, '"');
+
+      // 1
+      EXPECT_EQ(FindQuoteOrBackslash(text, 0), run);
+    }
+
+    // 2
+    EXPECT_EQ(FindQuoteOrBackslash(std::string(100, 'x'), 3), 100);
+  });
+}
+
+TEST(ScanTest, FindInvalidUtf8) {
+  ForEachKernel([]() {
+    // Characters of every length and invalid sequences of every kind
+    const std::string valid[] = {"a", "\u00e9", "\u20ac", "\U0001F600",
+                                 "\U0010FFFF", "\uFFFF"};
+    const std::string invalid[] = {
+        "\x80",             // Lone continuation byte
+        "\xC0\xAF",         // Overlong 2 byte lead
+        "\xE0\x80\xAF",     // Overlong 3 byte encoding
+        "\xF0\x80\x80\xAF",  // Overlong 4 byte encoding
+        "\xED\xA0\x80",     // Surrogate
+        "\xF4\x90\x80\x80",  // Past U+10FFFF
+        "\xF5\x80\x80\x80",  // Bad lead byte
+        "\xE2\x82",         // Missing continuation byte
+        "\xC3\xA9\xA9",     // Extra continuation byte after a valid one
+        "\xE2\x82 ",        // Cut by an ASCII byte
+    };
+
+    for (std::size_t run = 0; run < 70; run++) {
+      std::string prefix;
+      for (std::size_t i = 0; prefix.size() < run; i++) prefix += valid[i % 6];
+
+      // 1
+      std::string text = prefix + std::string(40, 'x') + prefix;
+      EXPECT_EQ(FindInvalidUtf8(text, 0), text.size()) << run;
+
+      for (const std::string &bad : invalid) {
+        // 2 : The position of the invalid sequence is reported (an extra
+        // continuation byte is reported, not the valid character before it)
+        std::size_t expected = prefix.size() + (bad == "\xC3\xA9\xA9" ? 2 : 0);
+        text = prefix + bad + std::string(40, 'y');
+        EXPECT_EQ(FindInvalidUtf8(text, 0), expected) << run << " " << bad;
+
+        // 3 : Sequence cut by the end of the text
+        if (bad == "\xE2\x82") {
+          text = prefix + bad;
+          EXPECT_EQ(FindInvalidUtf8(text, 0), prefix.size()) << run;
+        }
+      }
+    }
+  });
+}
+
+TEST(ScanTest, CollectLineStarts) {
+  ForEachKernel([]() {
+    // Newlines at every distance from the 16 and 32 byte block boundaries
+    std::string text;
+    std::vector<std::uint32_t> expected;
+    for (std::size_t run = 0; run < 80; run++) {
+      text += std::string(run, 'x') + "\n";
+      expected.push_back(static_cast<std::uint32_t>(text.size()));
+    }
+    text += "tail";
+
+    // 1
+    std::vector<std::uint32_t> line_starts;
+    CollectLineStarts(text, &line_starts);
+    EXPECT_EQ(line_starts, expected);
+
+    // 2 : Appends to what is already there
+    line_starts = {0};
+    CollectLineStarts("a\n\nb\r\n", &line_starts);
+    EXPECT_EQ(line_starts, (std::vector<std::uint32_t>{0, 2, 3, 6}));
+  });
+}
+
+TEST(ScanTest, KernelsMatchScalar) {
+  // 1 : The scalar kernel runs on every CPU, the reference for the others
+  const ScanKernel active = ActiveScanKernel();
+  ASSERT_TRUE(SetScanKernel(ScanKernel::SCALAR));
+
+  // Random bytes, mostly from the classes the kernels look for
+  const std::string alphabet = " \t\r\naZ_09\"\\+\xC3\xA9\xE2\x82\xAC\xF0\x80";
+  std::uint32_t seed = 12345;
+  std::vector<std::string> texts;
+  for (std::size_t length = 0; length < 200; length++) {
+    std::string text;
+    for (std::size_t i = 0; i < length; i++) {
+      seed = seed * 1103515245 + 12345;
+      text += alphabet[(seed >> 16) % alphabet.size()];
+    }
+    texts.push_back(text);
+  }
+
+  auto results = [&texts]() {
+    std::vector<std::size_t> found;
+    std::vector<std::uint32_t> line_starts;
+    for (const std::string &text : texts) {
+      for (std::size_t pos = 0; pos <= text.size(); pos++) {
+        found.push_back(SkipWhitespace(text, pos));
+        found.push_back(SkipIdentifier(text, pos));
+        found.push_back(SkipDigits(text, pos));
+        found.push_back(FindQuoteOrBackslash(text, pos));
+        found.push_back(FindInvalidUtf8(text, pos));
+      }
+      CollectLineStarts(text, &line_starts);
+    }
+    return std::make_pair(found, line_starts);
+  };
+  const auto expected = results();
+
+  // 2
+  for (ScanKernel kernel : {ScanKernel::SSE2, ScanKernel::AVX2}) {
+    if (!SetScanKernel(kernel)) continue;
+    EXPECT_EQ(results(), expected) << static_cast<int>(kernel);
+  }
+
+  // 3 : Unknown kernels are refused
+  EXPECT_FALSE(SetScanKernel(static_cast<ScanKernel>(7)));
+  SetScanKernel(active);
+}
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+
+#include "lexer.hpp"
+#include "operator_registry.hpp"
+#include "stream_lexer.hpp"
+#include "token.hpp"
+
+namespace {
+
+// Write the script to an anonymous temporary file and rewind it
+std::FILE *WriteScript(const std::string &script) {
+  std::FILE *file = std::tmpfile();
+  std::fputs(script.c_str(), file);
+  std::rewind(file);
+  return file;
+}
+
+}  // namespace
+
+TEST(StreamLexerTest, SameTokensForEveryChunkSize) {
+  std::string script;
+  for (int i = 0; i < 20; i++) {
+    script += "set variable" + std::to_string(i) + " = 12.5 * (3 != 4)\n";
+    script += "  \"string \\\" with a long body " + std::to_string(i) + "\"\n";
+    script += "1e+5 - 0x1F\n";
+    script += "\"\\uD83D\\uDE02 \\u00e9\"\n";
+    script += "set \u540d\u524d\U0001D400 = \"\u00e9\u20ac\U0001F600\"\n";
+  }
+
+  for (std::size_t chunk_size : {1, 2, 3, 7, 16, 100, 4096}) {
+    std::FILE *file = WriteScript(script);
+    StreamLexer stream = StreamLexer(fileno(file), chunk_size);
+    Lexer lexer = Lexer(script);
+
+    TokenPtr expected;
+    do {
+      expected = lexer.NextToken();
+
+      // 1
+      EXPECT_EQ(*(stream.NextToken()), *expected) << chunk_size;
+    } while (expected->Type() != TokenType::EOL);
+
+    // 2
+    EXPECT_EQ(stream.Offset(), script.size());
+
+    std::fclose(file);
+  }
+}
+
+TEST(StreamLexerTest, LexingException) {
+  // 1 : Unterminated string at the end of the script
+  std::FILE *file1 = WriteScript("1 + \"Hello");
+  StreamLexer test1 = StreamLexer(fileno(file1), 2);
+  EXPECT_EQ(test1.NextToken()->Type(), TokenType::NUMBER);
+  EXPECT_EQ(test1.NextToken()->Type(), TokenType::WHITESPACE);
+  EXPECT_EQ(test1.NextToken()->Type(), TokenType::OPERATOR);
+  EXPECT_EQ(test1.NextToken()->Type(), TokenType::WHITESPACE);
+  EXPECT_THROW(test1.NextToken(), WrongLexingException);
+  std::fclose(file1);
+
+  // 2 : Invalid token in the middle of a chunk
+  std::FILE *file2 = WriteScript("a $ b");
+  StreamLexer test2 = StreamLexer(fileno(file2), 64);
+  EXPECT_EQ(test2.NextToken()->Type(), TokenType::IDENTIFIER);
+  EXPECT_EQ(test2.NextToken()->Type(), TokenType::WHITESPACE);
+  EXPECT_THROW(test2.NextToken(), WrongLexingException);
+  std::fclose(file2);
+
+  // 3 : Errors after several chunks are located in the whole script
+  std::string script;
+  for (int i = 0; i < 10; i++) script += "set a" + std::to_string(i) + " = 1\n";
+  const std::string invalid_scripts[] = {script + "a + b $ c",
+                                         script + "a\n  \"Hello"};
+  for (const std::string &invalid : invalid_scripts) {
+    std::string expected;
+    try {
+      Lexer(invalid).Tokenize();
+    } catch (const WrongLexingException &e) {
+      expected = e.what();
+    }
+    ASSERT_FALSE(expected.empty());
+
+    for (std::size_t chunk_size : {1, 3, 7, 64}) {
+      std::FILE *file = WriteScript(invalid);
+      StreamLexer stream = StreamLexer(fileno(file), chunk_size);
+      try {
+        while (stream.NextToken()->Type() != TokenType::EOL) {
+        }
+        ADD_FAILURE() << "No error thrown";
+      } catch (const WrongLexingException &e) {
+        EXPECT_EQ(e.what(), expected) << chunk_size;
+      }
+      std::fclose(file);
+    }
+  }
+
+  // 4
+  EXPECT_THROW(StreamLexer("/nonexistent/script.ap"), FileNotOpenedException);
+}
+
+TEST(StreamLexerTest, RegisteredOperators) {
+  OperatorRegistry registry;
+  registry.RegisterInfix("|||>", 2, Associativity::LEFT);
+  registry.RegisterInfix("|", 3, Associativity::LEFT);
+  std::string script;
+  for (int i = 0; i < 20; i++) script += "a|||>b | c |||>d\n";
+
+  for (std::size_t chunk_size : {1, 2, 3, 5, 64}) {
+    std::FILE *file = WriteScript(script);
+    StreamLexer stream = StreamLexer(fileno(file), chunk_size);
+    stream.SetOperators(registry);
+    Lexer lexer = Lexer(script);
+    lexer.SetOperators(registry);
+
+    TokenPtr expected;
+    do {
+      expected = lexer.NextToken();
+
+      // 1 : Operators longer than the built-in lookahead are not cut
+      EXPECT_EQ(*(stream.NextToken()), *expected) << chunk_size;
+    } while (expected->Type() != TokenType::EOL);
+
+    std::fclose(file);
+  }
+}
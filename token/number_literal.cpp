@@ -0,0 +1,89 @@
+#include "number_literal.hpp"
+
+#include <cctype>
+#include <charconv>
+#include <string>
+#include <system_error>
+
+namespace {
+
+bool IsDigitOfBase(char ch, int base) {
+  switch (base) {
+    case 2:
+      return ch == '0' || ch == '1';
+    case 16:
+      return std::isxdigit(static_cast<unsigned char>(ch));
+    default:
+      return std::isdigit(static_cast<unsigned char>(ch));
+  }
+}
+
+/**
+ * @brief Remove the digit separators, which must sit between two digits
+ * @param text the literal (or its digits after a 0x/0b prefix)
+ * @param base the base of the digits
+ * @param digits receives the literal without separators
+ * @return bool false if a separator is misplaced
+ */
+bool StripSeparators(std::string_view text, int base, std::string *digits) {
+  digits->reserve(text.size());
+  for (std::size_t i = 0; i < text.size(); i++) {
+    if (text[i] != '_') {
+      digits->push_back(text[i]);
+      continue;
+    }
+    if (i == 0 || i + 1 == text.size() || !IsDigitOfBase(text[i - 1], base) ||
+        !IsDigitOfBase(text[i + 1], base)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+bool DecodeNumberLiteral(std::string_view text, double *value) {
+  int base = 10;
+  if (text.size() > 1 && text[0] == '0') {
+    if (text[1] == 'x' || text[1] == 'X') base = 16;
+    if (text[1] == 'b' || text[1] == 'B') base = 2;
+  }
+  if (base != 10) text.remove_prefix(2);
+
+  // Separators are rare, only then is the literal copied
+  std::string digits;
+  if (text.find('_') != std::string_view::npos) {
+    if (!StripSeparators(text, base, &digits)) return false;
+    text = digits;
+  }
+
+  if (text.empty()) return false;
+
+  if (base == 2) {
+    double number = 0;
+    for (char ch : text) {
+      if (ch != '0' && ch != '1') return false;
+      number = number * 2 + (ch - '0');
+    }
+    *value = number;
+    return true;
+  }
+
+  // from_chars would also accept a hexadecimal float exponent ('p')
+  if (base == 16) {
+    for (char ch : text) {
+      if (!IsDigitOfBase(ch, 16)) return false;
+    }
+  }
+
+  double number;
+  std::from_chars_result result =
+      std::from_chars(text.data(), text.data() + text.size(), number,
+                      base == 16 ? std::chars_format::hex
+                                 : std::chars_format::general);
+  if (result.ec != std::errc() || result.ptr != text.data() + text.size())
+    return false;
+
+  *value = number;
+  return true;
+}
@@ -0,0 +1,22 @@
+/**
+ * @file number_literal.hpp
+ * @brief Decoding of numeric literals into their double value, done once by
+ * the Lexer so the parser and the runtime never convert number text again
+ */
+#ifndef NUMBER_LITERAL_H
+#define NUMBER_LITERAL_H
+
+#include <string_view>
+
+/**
+ * @brief Decode a numeric literal. Accepted forms:
+ * decimal with optional fraction and exponent (12, 1.5, 1e9, 2.5E-3),
+ * hexadecimal (0xFF) and binary (0b101), all with '_' digit separators
+ * between two digits (1_000_000, 0xFF_FF).
+ * @param text the literal, without sign
+ * @param value receives the number (unchanged on failure)
+ * @return bool false if the literal is malformed or out of the double range
+ */
+bool DecodeNumberLiteral(std::string_view text, double *value);
+
+#endif
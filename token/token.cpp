@@ -1,11 +1,29 @@
 #include "token.hpp"
 
-Token::Token(const std::string &input, TokenType tok_type, OperatorPtr op) {
+#include <limits>
+
+#include "number_literal.hpp"
+
+Token::Token(std::string_view input, TokenType tok_type, OperatorPtr op,
+             std::uint32_t offset) {
   value_ = input;
   tok_type_ = tok_type;
   op_ = op;
+  offset_ = offset;
+  number_ = 0;
+  if (tok_type == TokenType::NUMBER &&
+      !DecodeNumberLiteral(input, &number_)) {
+    number_ = std::numeric_limits<double>::quiet_NaN();
+  }
 };
 
+Token::Token(std::string_view input, double number, std::uint32_t offset)
+    : tok_type_(TokenType::NUMBER),
+      value_(input),
+      op_(nullptr),
+      offset_(offset),
+      number_(number) {}
+
 Token::~Token(){
 
 };
@@ -53,7 +71,12 @@ std::string Token::PrintTokenType(TokenType tok_type) {
   }
 }
 
-TokenPtr GenerateToken(const std::string &input, TokenType tok_type,
-                       OperatorPtr op) {
-  return TokenPtr(new Token(input, tok_type, op));
+TokenPtr GenerateToken(std::string_view input, TokenType tok_type,
+                       OperatorPtr op, std::uint32_t offset) {
+  return TokenPtr(new Token(input, tok_type, op, offset));
+}
+
+TokenPtr GenerateNumberToken(std::string_view input, double number,
+                             std::uint32_t offset) {
+  return TokenPtr(new Token(input, number, offset));
 }
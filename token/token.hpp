@@ -5,8 +5,11 @@
 #ifndef TOKEN_H
 #define TOKEN_H
 
+#include <array>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
 
 #include "file.hpp"
 #include "operator.hpp"
@@ -14,7 +17,7 @@
 /**
  * @brief Enum class to represent different token types.
  */
-enum class TokenType {
+enum class TokenType : std::uint8_t {
   EOL,
   INVALID,
   IDENTIFIER,
@@ -32,6 +35,30 @@ enum class TokenType {
   NULLABLE
 };
 
+/**
+ * @brief Spelling of a reserved keyword and the TokenType it is lexed as
+ */
+struct ReservedKeyword {
+  std::string_view text;
+  TokenType tok_type;
+};
+
+/**
+ * @brief Every reserved keyword of the language. When a keyword TokenType is
+ * added, add its spelling here; the lexer's keyword hash is generated from
+ * this table at compile time.
+ */
+inline constexpr std::array<ReservedKeyword, 8> kReservedKeywords = {{
+    {"func", TokenType::FUNCTION},
+    {"if", TokenType::IF},
+    {"set", TokenType::SET},
+    {"true", TokenType::TRUE},
+    {"false", TokenType::FALSE},
+    {"for", TokenType::FOR},
+    {"return", TokenType::RETURN},
+    {"null", TokenType::NULLABLE},
+}};
+
 /**
  * @brief Token class used to represent a token in the lexer
  */
@@ -40,6 +67,11 @@ class Token {
   TokenType tok_type_;
   std::string value_;
   OperatorPtr op_;
+  // Byte offset of the token in its source, turned into a line and column by
+  // a LineTable when needed
+  std::uint32_t offset_;
+  // Value of a TokenType::NUMBER token
+  double number_;
 
  public:
   /**
@@ -47,8 +79,18 @@ class Token {
    * @param input The value of the token
    * @param tok_type The type of the token
    * @param op The operator associated with the token (if not, nullptr)
+   * @param offset The byte offset of the token in its source
    */
-  Token(const std::string &input, TokenType tok_type, OperatorPtr op);
+  Token(std::string_view input, TokenType tok_type, OperatorPtr op,
+        std::uint32_t offset = 0);
+  /**
+   * @brief Constructor for a TokenType::NUMBER token whose value is already
+   * decoded
+   * @param input The literal of the number
+   * @param number The value of the number
+   * @param offset The byte offset of the token in its source
+   */
+  Token(std::string_view input, double number, std::uint32_t offset = 0);
   ~Token();
 
   /**
@@ -70,6 +112,19 @@ class Token {
    */
   OperatorPtr OpPtr() const;
 
+  /**
+   * @brief Get the byte offset of the token in its source
+   * @return Byte offset of the token (0 if the token was not lexed)
+   */
+  std::uint32_t Offset() const { return offset_; }
+
+  /**
+   * @brief Get the value of a number token
+   * @return The value of the TokenType::NUMBER token (NaN if its text is not
+   * a valid number literal, 0 for other tokens)
+   */
+  double Number() const { return number_; }
+
   /**
    * @brief Print the token type as a string
    * @param tok_type The token type to check what the value is in string form
@@ -107,9 +162,21 @@ typedef std::shared_ptr<Token> TokenPtr;
  * @param input The value of the token
  * @param tok_type The type of the token
  * @param op The operator associated with the token (if not, nullptr)
+ * @param offset The byte offset of the token in its source
+ * @return Token shared pointer of the generated token
+ */
+TokenPtr GenerateToken(std::string_view input, TokenType tok_type,
+                       OperatorPtr op, std::uint32_t offset = 0);
+
+/**
+ * @brief Generate a smart pointer TokenType::NUMBER token with its decoded
+ * value
+ * @param input The literal of the number
+ * @param number The value of the number
+ * @param offset The byte offset of the token in its source
  * @return Token shared pointer of the generated token
  */
-TokenPtr GenerateToken(const std::string &input, TokenType tok_type,
-                       OperatorPtr op);
+TokenPtr GenerateNumberToken(std::string_view input, double number,
+                             std::uint32_t offset = 0);
 
 #endif
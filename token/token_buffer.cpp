@@ -0,0 +1,220 @@
+#include "token_buffer.hpp"
+
+#include <algorithm>
+#include <unordered_set>
+#include <utility>
+
+TokenBuffer::TokenBuffer() {}
+
+TokenBuffer::TokenBuffer(std::string_view source) : source_(source) {}
+
+TokenBuffer::TokenBuffer(std::shared_ptr<const std::string> source)
+    : source_(*source), source_owner_(std::move(source)) {}
+
+TokenBuffer::TokenBuffer(std::string_view source,
+                         std::shared_ptr<const void> owner)
+    : source_(source), source_owner_(std::move(owner)) {}
+
+double TokenBuffer::Chunk::Number(std::size_t index) const {
+  auto number = std::lower_bound(number_indices.begin(), number_indices.end(),
+                                 static_cast<std::uint32_t>(index));
+  if (number == number_indices.end() || *number != index) return 0;
+  return number_values[number - number_indices.begin()];
+}
+
+TokenBuffer::Chunk &TokenBuffer::OpenChunk() {
+  if (!runs_.empty()) {
+    Run &last = runs_.back();
+    // Only a chunk no other buffer sees can change, and only at its end
+    if (last.chunk.use_count() == 1 && last.shift == 0 &&
+        last.begin + last.size == last.chunk->types.size() &&
+        last.chunk->types.size() < kChunkSize) {
+      return *last.chunk;
+    }
+  }
+
+  std::shared_ptr<Chunk> chunk = std::make_shared<Chunk>();
+  // A buffer which filled a chunk is likely to fill the next one as well
+  if (!runs_.empty()) {
+    chunk->types.reserve(kChunkSize);
+    chunk->op_types.reserve(kChunkSize);
+    chunk->offsets.reserve(kChunkSize);
+    chunk->lengths.reserve(kChunkSize);
+  }
+  runs_.push_back(Run{std::move(chunk), size_, 0, 0, 0});
+  return *runs_.back().chunk;
+}
+
+void TokenBuffer::Grow() {
+  if ((size_ & (kChunkSize - 1)) == 0)
+    block_runs_.push_back(static_cast<std::uint32_t>(runs_.size() - 1));
+  runs_.back().size++;
+  size_++;
+}
+
+void TokenBuffer::Append(TokenType tok_type, std::uint32_t offset,
+                         std::uint32_t length, OperatorType op_type) {
+  Chunk &chunk = OpenChunk();
+  chunk.types.push_back(tok_type);
+  chunk.op_types.push_back(op_type);
+  chunk.offsets.push_back(offset);
+  chunk.lengths.push_back(length);
+  Grow();
+}
+
+void TokenBuffer::AppendDecoded(TokenType tok_type, std::uint32_t offset,
+                                std::uint32_t length, std::string text) {
+  Chunk &chunk = OpenChunk();
+  chunk.decoded_text.emplace(static_cast<std::uint32_t>(chunk.types.size()),
+                             std::move(text));
+  Append(tok_type, offset, length);
+}
+
+void TokenBuffer::AppendNumber(std::uint32_t offset, std::uint32_t length,
+                               double number) {
+  Chunk &chunk = OpenChunk();
+  chunk.number_indices.push_back(
+      static_cast<std::uint32_t>(chunk.types.size()));
+  chunk.number_values.push_back(number);
+  Append(TokenType::NUMBER, offset, length);
+}
+
+void TokenBuffer::AppendRun(Run run) {
+  run.first = size_;
+  runs_.push_back(std::move(run));
+  size_ += runs_.back().size;
+  while (block_runs_.size() << kChunkBits < size_)
+    block_runs_.push_back(static_cast<std::uint32_t>(runs_.size() - 1));
+}
+
+void TokenBuffer::AppendCopy(const Run &run, std::size_t index,
+                             std::int64_t shift) {
+  const Chunk &chunk = *run.chunk;
+  std::uint32_t offset =
+      static_cast<std::uint32_t>(chunk.offsets[index] + run.shift + shift);
+
+  if (chunk.types[index] == TokenType::NUMBER) {
+    AppendNumber(offset, chunk.lengths[index], chunk.Number(index));
+    return;
+  }
+
+  if (!chunk.decoded_text.empty()) {
+    auto decoded = chunk.decoded_text.find(static_cast<std::uint32_t>(index));
+    if (decoded != chunk.decoded_text.end()) {
+      AppendDecoded(chunk.types[index], offset, chunk.lengths[index],
+                    decoded->second);
+      return;
+    }
+  }
+
+  Append(chunk.types[index], offset, chunk.lengths[index],
+         chunk.op_types[index]);
+}
+
+void TokenBuffer::AppendRange(const TokenBuffer &other, std::size_t begin,
+                              std::size_t end, std::int64_t shift) {
+  if (begin >= end) return;
+
+  const Run *run = other.Locate(begin).first;
+  for (; begin < end; run++) {
+    std::size_t run_end = std::min(end, run->first + run->size);
+    std::uint32_t from = static_cast<std::uint32_t>(run->begin + begin -
+                                                    run->first);
+    std::uint32_t count = static_cast<std::uint32_t>(run_end - begin);
+
+    // A short run left by an earlier edit is shared as well, unless it would
+    // follow another short run: it is merged into it instead
+    bool whole = from == run->begin && count == run->size;
+    bool after_short = !runs_.empty() && runs_.back().size < kMinSharedRun;
+    if (count >= kMinSharedRun || (whole && !after_short)) {
+      AppendRun(Run{run->chunk, 0, from, count, run->shift + shift});
+    } else {
+      for (std::uint32_t i = from; i < from + count; i++)
+        AppendCopy(*run, i, shift);
+    }
+    begin = run_end;
+  }
+}
+
+void TokenBuffer::Reserve(std::size_t capacity) {
+  runs_.reserve(capacity / kChunkSize + 1);
+  block_runs_.reserve(capacity / kChunkSize + 1);
+}
+
+void TokenBuffer::Clear() {
+  runs_.clear();
+  block_runs_.clear();
+  size_ = 0;
+}
+
+std::string_view TokenBuffer::Text(std::size_t index) const {
+  auto [run, i] = Locate(index);
+  const Chunk &chunk = *run->chunk;
+  std::uint32_t offset = static_cast<std::uint32_t>(chunk.offsets[i] +
+                                                    run->shift);
+  if (chunk.types[i] != TokenType::STRING)
+    return source_.substr(offset, chunk.lengths[i]);
+
+  if (!chunk.decoded_text.empty()) {
+    auto decoded = chunk.decoded_text.find(static_cast<std::uint32_t>(i));
+    if (decoded != chunk.decoded_text.end()) return decoded->second;
+  }
+
+  // Strip the surrounding double quotes
+  return source_.substr(offset + 1, chunk.lengths[i] - 2);
+}
+
+void TokenBuffer::DiscardFront(std::size_t count) {
+  if (count >= Size()) {
+    Clear();
+    return;
+  }
+
+  // Narrowing the first kept run drops the tokens before it, the chunks are
+  // freed once no run refers to them
+  auto first_kept = runs_.begin() + (Locate(count).first - runs_.data());
+  runs_.erase(runs_.begin(), first_kept);
+  std::uint32_t dropped = static_cast<std::uint32_t>(count - runs_[0].first);
+  runs_[0].begin += dropped;
+  runs_[0].size -= dropped;
+
+  std::vector<Run> runs = std::move(runs_);
+  runs_.clear();
+  block_runs_.clear();
+  size_ = 0;
+  for (Run &run : runs) AppendRun(std::move(run));
+}
+
+double TokenBuffer::Number(std::size_t index) const {
+  auto [run, i] = Locate(index);
+  return run->chunk->Number(i);
+}
+
+std::string_view TokenBuffer::LeadingTrivia(std::size_t index) const {
+  std::uint32_t start = index == 0 ? 0 : Offset(index - 1) + Length(index - 1);
+  return source_.substr(start, Offset(index) - start);
+}
+
+TokenPtr TokenBuffer::ToToken(std::size_t index) const {
+  if (Type(index) == TokenType::NUMBER)
+    return GenerateNumberToken(Text(index), Number(index), Offset(index));
+
+  OperatorPtr op = OperatorPtr(nullptr);
+  if (Type(index) == TokenType::OPERATOR) {
+    const OperatorInfo *info = operators_->Find(OpType(index));
+    op = info != nullptr ? GenerateOp(*info) : GenerateOp(OpType(index));
+  }
+
+  return GenerateToken(Text(index), Type(index), op, Offset(index));
+}
+
+std::size_t TokenBuffer::SharedWith(const TokenBuffer &other) const {
+  std::unordered_set<const Chunk *> other_chunks;
+  for (const Run &run : other.runs_) other_chunks.insert(run.chunk.get());
+
+  std::size_t shared = 0;
+  for (const Run &run : runs_) {
+    if (other_chunks.count(run.chunk.get()) != 0) shared += run.size;
+  }
+  return shared;
+}
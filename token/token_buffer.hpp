@@ -0,0 +1,337 @@
+/**
+ * @file token_buffer.hpp
+ * @brief Contains the TokenBuffer class, a flat list of tokens which refer back
+ * into the lexed source instead of owning their text
+ */
+#ifndef TOKEN_BUFFER_H
+#define TOKEN_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "operator.hpp"
+#include "operator_registry.hpp"
+#include "token.hpp"
+
+/**
+ * @brief Structure of arrays holding every token of a source text.
+ * Each token is stored as its TokenType, OperatorType and the byte range
+ * (offset, length) it covers in the source, so a token costs 10 bytes and no
+ * allocation. Sources are limited to 4 GiB (32-bit offsets). Number values
+ * and escaped string literals are kept in side tables.
+ *
+ * The arrays are split into chunks of about kChunkSize tokens, which buffers
+ * share instead of copying: copying a TokenBuffer, or appending a long range
+ * of another one (see Lexer::Relex), only takes a reference to its chunks.
+ * A shared chunk is never changed, a buffer moves the offsets of the tokens
+ * it refers to by a shift of its own.
+ */
+class TokenBuffer {
+ public:
+  /**
+   * @brief Number of tokens of the chunks a buffer appends to
+   */
+  static constexpr std::size_t kChunkSize = 4096;
+
+ private:
+  static constexpr std::size_t kChunkBits = 12;
+  static_assert(kChunkSize == std::size_t{1} << kChunkBits);
+
+  // Parts of runs shorter than that are copied by AppendRange(), so the
+  // tokens of a buffer are not spread over many short runs (there are no two
+  // short runs in a row, Locate() goes through few runs)
+  static constexpr std::size_t kMinSharedRun = kChunkSize / 4;
+
+  /**
+   * @brief Tokens appended one after another, with the offsets of the source
+   * they were lexed from
+   */
+  struct Chunk {
+    std::vector<TokenType> types;
+    std::vector<OperatorType> op_types;
+    std::vector<std::uint32_t> offsets;
+    std::vector<std::uint32_t> lengths;
+
+    // Text of the tokens which differs from their source range (string
+    // literals with escape sequences), keyed by token index in the chunk
+    std::unordered_map<std::uint32_t, std::string> decoded_text;
+
+    // Values of the TokenType::NUMBER tokens, number_values[k] belongs to the
+    // token at index number_indices[k] of the chunk (increasing)
+    std::vector<std::uint32_t> number_indices;
+    std::vector<double> number_values;
+
+    /**
+     * @brief Get the value of a TokenType::NUMBER token
+     * @param index the index of the token in the chunk
+     * @return double the value of the number (0 if the token is not a number)
+     */
+    double Number(std::size_t index) const;
+  };
+
+  /**
+   * @brief Consecutive tokens of a chunk, as they appear in the buffer
+   */
+  struct Run {
+    std::shared_ptr<Chunk> chunk;
+    // Index in the buffer of the first token of the run
+    std::size_t first;
+    // Index in the chunk of the first token of the run
+    std::uint32_t begin;
+    std::uint32_t size;
+    // Added to the offsets of the chunk (the source was edited before them)
+    std::int64_t shift;
+  };
+
+  std::string_view source_;
+  // Keeps source_ alive when the buffer shares ownership of its text
+  std::shared_ptr<const void> source_owner_;
+
+  std::vector<Run> runs_;
+  // Index in runs_ of the run holding token k * kChunkSize, for every k, so a
+  // token is found without searching all the runs
+  std::vector<std::uint32_t> block_runs_;
+  std::size_t size_ = 0;
+
+  // Operators the OpType() of the tokens refer to
+  const OperatorRegistry *operators_ = &OperatorRegistry::Builtin();
+
+  /**
+   * @brief Find the run holding a token
+   * @param index the index of the token
+   * @return std::pair<const Run *, std::size_t> the run, and the index of the
+   * token in its chunk
+   */
+  std::pair<const Run *, std::size_t> Locate(std::size_t index) const {
+    const Run *run = runs_.data() + block_runs_[index >> kChunkBits];
+    // Usually the run holding the start of the block holds the token too
+    const Run *last = runs_.data() + runs_.size() - 1;
+    while (run != last && run[1].first <= index) run++;
+    return {run, run->begin + (index - run->first)};
+  }
+
+  /**
+   * @brief Get the chunk the next token is appended to, starting a new one
+   * when the last chunk is full or shared
+   * @return Chunk & the chunk at the end of the last run
+   */
+  Chunk &OpenChunk();
+
+  /**
+   * @brief Count a token appended to the chunk of the last run
+   */
+  void Grow();
+
+  /**
+   * @brief Append a run of tokens, shared with the buffers it comes from
+   * @param run the run, its first field is set to the end of the buffer
+   */
+  void AppendRun(Run run);
+
+  /**
+   * @brief Append a copy of a token of a run
+   * @param run the run holding the token
+   * @param index the index of the token in the run's chunk
+   * @param shift the number of bytes the token moved in the source
+   */
+  void AppendCopy(const Run &run, std::size_t index, std::int64_t shift);
+
+ public:
+  /**
+   * @brief Construct an empty TokenBuffer without source text
+   */
+  TokenBuffer();
+  /**
+   * @brief Construct an empty TokenBuffer borrowing the source text
+   * @pre The source text must outlive the TokenBuffer
+   * @param source the text the tokens refer to
+   */
+  explicit TokenBuffer(std::string_view source);
+  /**
+   * @brief Construct an empty TokenBuffer sharing ownership of the source text
+   * @param source the text the tokens refer to
+   */
+  explicit TokenBuffer(std::shared_ptr<const std::string> source);
+  /**
+   * @brief Construct an empty TokenBuffer sharing ownership of the object
+   * holding the source text (e.g. a memory mapped File)
+   * @param source the text the tokens refer to
+   * @param owner the object keeping the source text alive
+   */
+  TokenBuffer(std::string_view source, std::shared_ptr<const void> owner);
+
+  /**
+   * @brief Append a token which covers source()[offset, offset + length)
+   * @param tok_type the type of the token
+   * @param offset the byte offset of the token in the source
+   * @param length the number of bytes the token covers in the source
+   * @param op_type the OperatorType of an operator token (else
+   * OperatorType::INVALID)
+   */
+  void Append(TokenType tok_type, std::uint32_t offset, std::uint32_t length,
+              OperatorType op_type = OperatorType::INVALID);
+
+  /**
+   * @brief Append a token whose text differs from its source range
+   * @param tok_type the type of the token
+   * @param offset the byte offset of the token in the source
+   * @param length the number of bytes the token covers in the source
+   * @param text the text of the token returned by Text()
+   */
+  void AppendDecoded(TokenType tok_type, std::uint32_t offset,
+                     std::uint32_t length, std::string text);
+
+  /**
+   * @brief Append a TokenType::NUMBER token with its decoded value
+   * @param offset the byte offset of the token in the source
+   * @param length the number of bytes the token covers in the source
+   * @param number the value of the number literal
+   */
+  void AppendNumber(std::uint32_t offset, std::uint32_t length, double number);
+
+  /**
+   * @brief Append tokens of another TokenBuffer, moved by a number of bytes
+   * (used when the other buffer's source was edited before them). The chunks
+   * of the other buffer are shared, only short pieces at the ends of the
+   * range are copied, so the time depends on the number of chunks rather
+   * than tokens.
+   * @param other the buffer holding the tokens
+   * @param begin the index of the first token in the other buffer
+   * @param end the index after the last token in the other buffer
+   * @param shift the number of bytes the tokens moved in the source
+   */
+  void AppendRange(const TokenBuffer &other, std::size_t begin,
+                   std::size_t end, std::int64_t shift);
+
+  /**
+   * @brief Reserve space for the runs of a number of tokens
+   * @param capacity the number of tokens to reserve
+   */
+  void Reserve(std::size_t capacity);
+
+  /**
+   * @brief Remove every token (the source is kept)
+   */
+  void Clear();
+
+  /**
+   * @brief Remove the first tokens, the following ones move to the front
+   * (used to bound a buffer which tokens are pulled into)
+   * @param count the number of tokens to remove
+   */
+  void DiscardFront(std::size_t count);
+
+  /**
+   * @brief Get the number of tokens
+   * @return std::size_t the number of tokens
+   */
+  std::size_t Size() const { return size_; }
+
+  /**
+   * @brief Choose the registry the OperatorType of the tokens belong to (by
+   * default OperatorRegistry::Builtin())
+   * @pre The registry must outlive the TokenBuffer
+   * @param operators the registry of the operators
+   */
+  void SetOperators(const OperatorRegistry &operators) {
+    operators_ = &operators;
+  }
+
+  /**
+   * @brief Get the source text the tokens refer to
+   * @return std::string_view the source text
+   */
+  std::string_view Source() const { return source_; }
+
+  /**
+   * @brief Get the TokenType of a token
+   * @param index the index of the token
+   * @return TokenType the type of the token
+   */
+  TokenType Type(std::size_t index) const {
+    auto [run, i] = Locate(index);
+    return run->chunk->types[i];
+  }
+
+  /**
+   * @brief Get the OperatorType of a token
+   * @param index the index of the token
+   * @return OperatorType the operator type, OperatorType::INVALID if the token
+   * is not an operator
+   */
+  OperatorType OpType(std::size_t index) const {
+    auto [run, i] = Locate(index);
+    return run->chunk->op_types[i];
+  }
+
+  /**
+   * @brief Get the byte offset of a token in the source
+   * @param index the index of the token
+   * @return std::uint32_t the byte offset of the token
+   */
+  std::uint32_t Offset(std::size_t index) const {
+    auto [run, i] = Locate(index);
+    return static_cast<std::uint32_t>(run->chunk->offsets[i] + run->shift);
+  }
+
+  /**
+   * @brief Get the number of source bytes a token covers
+   * @param index the index of the token
+   * @return std::uint32_t the number of bytes the token covers
+   */
+  std::uint32_t Length(std::size_t index) const {
+    auto [run, i] = Locate(index);
+    return run->chunk->lengths[i];
+  }
+
+  /**
+   * @brief Get the text of a token (same as Token::Text(), string literals
+   * without their quotes)
+   * @param index the index of the token
+   * @return std::string_view the text of the token, valid as long as the
+   * TokenBuffer and its source
+   */
+  std::string_view Text(std::size_t index) const;
+
+  /**
+   * @brief Get the value of a TokenType::NUMBER token, decoded by the Lexer
+   * @param index the index of the token
+   * @return double the value of the number (0 if the token is not a number)
+   */
+  double Number(std::size_t index) const;
+
+  /**
+   * @brief Get the source text skipped between the previous token (or the
+   * beginning of the source) and a token, i.e. the whitespace dropped by a
+   * Lexer which does not keep whitespace tokens. The gaps between the token
+   * ranges are the trivia table, nothing is stored for it.
+   * @param index the index of the token
+   * @return std::string_view the text before the token, empty when the
+   * tokens are adjacent
+   */
+  std::string_view LeadingTrivia(std::size_t index) const;
+
+  /**
+   * @brief Build a standalone Token from a token of the buffer (for error
+   * messages and debugging)
+   * @param index the index of the token
+   * @return TokenPtr the generated token
+   */
+  TokenPtr ToToken(std::size_t index) const;
+
+  /**
+   * @brief Count the tokens stored in chunks which another buffer refers to
+   * as well, e.g. the tokens a buffer returned by Lexer::Relex reuses
+   * @param other the other buffer
+   * @return std::size_t the number of tokens shared with the other buffer
+   */
+  std::size_t SharedWith(const TokenBuffer &other) const;
+};
+
+#endif
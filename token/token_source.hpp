@@ -0,0 +1,33 @@
+/**
+ * @file token_source.hpp
+ * @brief Contains the TokenSource interface, a producer of tokens pulled one
+ * at a time (e.g. by the Parser) instead of lexed into a TokenBuffer up front
+ */
+#ifndef TOKEN_SOURCE_H
+#define TOKEN_SOURCE_H
+
+#include "token_buffer.hpp"
+
+/**
+ * @brief Lazy producer of tokens. The consumer keeps the pulled tokens in a
+ * TokenBuffer of its own and decides how many of them to keep.
+ */
+class TokenSource {
+ public:
+  virtual ~TokenSource() = default;
+
+  /**
+   * @brief Build an empty TokenBuffer over the text of the tokens, for the
+   * consumer to pull the tokens into
+   * @return TokenBuffer the empty buffer
+   */
+  virtual TokenBuffer EmptyBuffer() const = 0;
+
+  /**
+   * @brief Append the next token to a buffer built by EmptyBuffer()
+   * @param tokens the buffer to append to
+   */
+  virtual void Pull(TokenBuffer *tokens) = 0;
+};
+
+#endif